@@ -8,6 +8,7 @@
 #include <chrono>
 #include <format>
 #include <iostream>
+#include <limits>
 #include <thread>
 #include <variant>
 
@@ -66,10 +67,16 @@ domain::Config getConfig()
 {
     if (exists(getConfigPath())) {
         if (auto res = loadConfig(getConfigPath())) {
-            if (auto val = validateConfig(*res)) {
-                return *res;
-            } else {
+            if (auto val = validateConfig(*res); !val) {
                 showError(val.error().c_str());
+            } else if (res->field_size.maxCoeff() > std::numeric_limits<domain::Scalar>::max()) {
+                // the config takes the larger fields of the simulator, the game engine coordinates are domain::Scalar
+                const auto message = std::format(
+                    "Invalid field size, the game takes up to {} cells per side.",
+                    int{std::numeric_limits<domain::Scalar>::max()});
+                showError(message.c_str());
+            } else {
+                return *res;
             }
         } else {
             showError(res.error().c_str());
@@ -0,0 +1,365 @@
+#include "logic/engine.h"
+#include "logic/static_engine.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_TSC 1
+#endif
+
+namespace {
+std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new(const std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+using ObjectType = logic::internal::ObjectMap::ObjectType;
+
+struct Result {
+    std::string name;
+    std::string field;
+    unsigned enemies{};
+    unsigned flowers{};
+    double density{};
+    uint64_t iterations{};
+    double ns_per_op{};
+    double allocations_per_op{};
+    std::optional<double> cycles_per_op{};
+};
+
+uint64_t readCycles()
+{
+#ifdef HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Runs the operation doubling the number of iterations until the run lasts at least min_time
+Result measure(Result result, const std::chrono::duration<double> min_time, const std::function<void()>& operation)
+{
+    for (uint64_t iterations = 1;; iterations *= 2) {
+        const auto start_allocations = allocations.load(std::memory_order_relaxed);
+        const auto start_cycles = readCycles();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            operation();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        const auto cycles = readCycles() - start_cycles;
+        const auto allocated = allocations.load(std::memory_order_relaxed) - start_allocations;
+        if (elapsed >= min_time || iterations >= (uint64_t{1} << 40)) {
+            const auto n = static_cast<double>(iterations);
+            result.iterations = iterations;
+            result.ns_per_op = elapsed.count() / n;
+            result.allocations_per_op = static_cast<double>(allocated) / n;
+#ifdef HAS_TSC
+            result.cycles_per_op = static_cast<double>(cycles) / n;
+#endif
+            return result;
+        }
+    }
+}
+
+domain::Config makeConfig(const int size, const unsigned enemies, const unsigned flowers)
+{
+    return domain::Config{
+        .field_size = {size, size},
+        .number_of_enemies = enemies,
+        .number_of_flowers = flowers,
+        .flower_scores_range = {5, 10},
+        // the games never end while benchmarking
+        .max_player_steps = std::numeric_limits<unsigned>::max(),
+        .min_player_scores = std::numeric_limits<unsigned>::max(),
+    };
+}
+
+bool fits(const domain::Config& config)
+{
+    return 1 + config.number_of_enemies + config.number_of_flowers <=
+        static_cast<unsigned>(config.field_size[0] * config.field_size[1]);
+}
+
+// First of the eight directions the player can step to, so every move is followed by the enemies turn
+template<class State>
+std::optional<domain::Vector> legalMove(const domain::Config& config, const State& state, const unsigned turn)
+{
+    static constexpr std::array<std::array<domain::Scalar, 2>, 8> directions{
+        {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}}};
+    for (unsigned i = 0; i < directions.size(); ++i) {
+        const auto& [dx, dy] = directions[(turn + i) % directions.size()];
+        const domain::Position pos = state.player.position + domain::Vector{dx, dy};
+        if (pos[0] >= 0 && pos[0] < config.field_size[0] && pos[1] >= 0 && pos[1] < config.field_size[1] &&
+            std::ranges::find(state.enemies.position, pos) == state.enemies.position.end()) {
+            return domain::Vector{dx, dy};
+        }
+    }
+    return std::nullopt;
+}
+
+void benchPlaceObject(std::vector<Result>& results, const std::chrono::duration<double> min_time)
+{
+    for (const int size: {8, 18, 64, 127}) {
+        for (const double density: {0.0, 0.5, 0.9, 0.99}) {
+            logic::internal::ObjectMap objects_map(size, size);
+            logic::internal::Random rng(1);
+            const auto occupied = static_cast<int>(density * size * size);
+            for (int i = 0; i < occupied; ++i) {
+                objects_map.placeObject(ObjectType::Flower, i, rng);
+            }
+            // the placed object is removed right away to keep the density
+            results.push_back(measure(
+                {.name = "place_object", .field = std::format("{}x{}", size, size), .density = density},
+                min_time,
+                [&] {
+                    const auto pos = objects_map.placeObject(ObjectType::Flower, 0, rng);
+                    objects_map.setType(pos, ObjectType::Empty);
+                }));
+        }
+    }
+}
+
+void benchStartGame(std::vector<Result>& results, const std::chrono::duration<double> min_time)
+{
+    for (const int size: {8, 18, 64, 127}) {
+        for (const auto& [enemies, flowers]: {std::pair{5u, 15u}, std::pair{50u, 150u}, std::pair{1000u, 3000u}}) {
+            const auto config = makeConfig(size, enemies, flowers);
+            if (!fits(config)) {
+                continue;
+            }
+            logic::Engine engine(config, 1);
+            results.push_back(measure(
+                {.name = "start_game",
+                 .field = std::format("{}x{}", size, size),
+                 .enemies = enemies,
+                 .flowers = flowers},
+                min_time,
+                [&] { engine.startGame(); }));
+        }
+    }
+}
+
+// Types of the 8 neighbours of a random cell, the enemies and the player look at the map this way
+template<class Map>
+void benchProbe(std::vector<Result>& results, const std::chrono::duration<double> min_time, const std::string_view name)
+{
+    for (const int size: {127, 1024, 4096}) {
+        Map objects_map(size, size);
+        logic::internal::Random rng(1);
+        constexpr double density = 0.1;
+        for (int i = 0; i < static_cast<int>(density * size * size); ++i) {
+            objects_map.placeObject(ObjectType::Flower, i, rng);
+        }
+        // more cells than the caches hold on the large fields, the same ones for every map
+        std::vector<std::array<int, 2>> cells(1 << 16);
+        for (auto& cell: cells) {
+            const auto bound = static_cast<uint32_t>(size - 2);
+            cell = {1 + static_cast<int>(rng.uniform(bound)), 1 + static_cast<int>(rng.uniform(bound))};
+        }
+        size_t next = 0;
+        int occupied = 0;
+        results.push_back(measure(
+            {.name = std::string(name), .field = std::format("{}x{}", size, size), .density = density},
+            min_time,
+            [&] {
+                const auto [x, y] = cells[next++ & (cells.size() - 1)];
+                for (int dx = -1; dx <= 1; ++dx) {
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        occupied += objects_map.getType(x + dx, y + dy) != ObjectType::Empty;
+                    }
+                }
+            }));
+    }
+}
+
+// One player step and the enemies turn after it
+template<class Engine = logic::Engine>
+void benchMove(
+    std::vector<Result>& results,
+    const std::chrono::duration<double> min_time,
+    const std::string_view name,
+    const int size,
+    const unsigned enemies,
+    const unsigned flowers,
+    const domain::EnemiesStrategy strategy = domain::EnemiesStrategy::Greedy)
+{
+    auto config = makeConfig(size, enemies, flowers);
+    config.enemies_strategy = strategy;
+    if (!fits(config)) {
+        return;
+    }
+    Engine engine(config, 1);
+    engine.startGame();
+    unsigned turn = 0;
+    results.push_back(measure(
+        {.name = std::string(name), .field = std::format("{}x{}", size, size), .enemies = enemies, .flowers = flowers},
+        min_time,
+        [&] {
+            if (const auto move = legalMove(config, engine.getState(), turn++)) {
+                engine.move(*move);
+            } else {
+                engine.startGame();
+            }
+        }));
+}
+
+std::string toJson(const std::vector<Result>& results)
+{
+    std::string json = "[\n";
+    for (const auto& r: results) {
+        json += std::format(
+            "  {{\"name\": \"{}\", \"field\": \"{}\", \"enemies\": {}, \"flowers\": {}, \"density\": {}, "
+            "\"iterations\": {}, \"ns_per_op\": {:.2f}, \"allocations_per_op\": {:.3f}, \"cycles_per_op\": {}}}{}\n",
+            r.name,
+            r.field,
+            r.enemies,
+            r.flowers,
+            r.density,
+            r.iterations,
+            r.ns_per_op,
+            r.allocations_per_op,
+            r.cycles_per_op ? std::format("{:.1f}", *r.cycles_per_op) : std::string("null"),
+            &r == &results.back() ? "" : ",");
+    }
+    json += "]\n";
+    return json;
+}
+
+std::string toTable(const std::vector<Result>& results)
+{
+    std::string table = std::format(
+        "{:<14}{:>9}{:>9}{:>9}{:>9}{:>14}{:>12}{:>14}\n",
+        "name",
+        "field",
+        "enemies",
+        "flowers",
+        "density",
+        "ns/op",
+        "allocs/op",
+        "cycles/op");
+    for (const auto& r: results) {
+        table += std::format(
+            "{:<14}{:>9}{:>9}{:>9}{:>9.2f}{:>14.1f}{:>12.3f}{:>14}\n",
+            r.name,
+            r.field,
+            r.enemies,
+            r.flowers,
+            r.density,
+            r.ns_per_op,
+            r.allocations_per_op,
+            r.cycles_per_op ? std::format("{:.0f}", *r.cycles_per_op) : std::string("-"));
+    }
+    return table;
+}
+
+} // namespace
+
+int main(const int argc, char** argv)
+{
+    bool json = false;
+    std::chrono::duration<double> min_time{0.1};
+    std::string_view filter;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::chrono::duration<double>(std::strtod(argv[++i], nullptr));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::cerr << "Usage: shadok_bench [--json] [--min-time <seconds>] [--filter <name>]" << std::endl;
+            return 1;
+        }
+    }
+    const auto enabled = [&](const std::string_view name) { return filter.empty() || name.contains(filter); };
+
+    std::vector<Result> results;
+    if (enabled("place_object")) {
+        benchPlaceObject(results, min_time);
+    }
+    if (enabled("start_game")) {
+        benchStartGame(results, min_time);
+    }
+    if (enabled("probe")) {
+        benchProbe<logic::internal::ObjectMap>(results, min_time, "probe");
+    }
+    if (enabled("probe_morton")) {
+        benchProbe<logic::internal::MortonObjectMap>(results, min_time, "probe_morton");
+    }
+    if (enabled("move")) {
+        for (const int size: {8, 18, 64, 127}) {
+            benchMove(results, min_time, "move", size, 5, 15);
+        }
+    }
+    if (enabled("move_bitboard")) {
+        for (const int size: {8, 18, 64}) {
+            benchMove<logic::BitboardEngine>(results, min_time, "move_bitboard", size, 5, 15);
+        }
+    }
+    if (enabled("move_padded")) {
+        for (const int size: {8, 18, 64, 127}) {
+            benchMove<logic::PaddedEngine>(results, min_time, "move_padded", size, 5, 15);
+        }
+    }
+    if (enabled("move_static")) {
+        benchMove<logic::DefaultStaticEngine>(results, min_time, "move_static", 18, 5, 15);
+    }
+    if (enabled("move_enemies")) {
+        for (const auto& [enemies, flowers]: {
+                 std::pair{5u, 5u},
+                 std::pair{5u, 50u},
+                 std::pair{50u, 150u},
+                 std::pair{500u, 1500u},
+                 std::pair{2000u, 10000u},
+                 std::pair{5000u, 5000u},
+                 std::pair{10000u, 2000u}}) {
+            benchMove(results, min_time, "move_enemies", 127, enemies, flowers);
+        }
+    }
+    if (enabled("move_enemies_optimal")) {
+        for (const auto& [enemies, flowers]: {
+                 std::pair{5u, 15u}, std::pair{50u, 150u}, std::pair{200u, 600u}, std::pair{500u, 1500u}}) {
+            benchMove(
+                results, min_time, "move_enemies_optimal", 127, enemies, flowers, domain::EnemiesStrategy::Optimal);
+        }
+    }
+    std::cout << (json ? toJson(results) : toTable(results));
+    return 0;
+}
@@ -5,7 +5,15 @@
 
 namespace domain {
 
-using Size = Eigen::Array<Scalar, 2, 1>;
+using Size = Eigen::Array<int, 2, 1>;
+
+// How the enemies are matched to the flowers threatened by the player
+enum class EnemiesStrategy {
+    // the flowers nearest to the player take the nearest free enemy one by one
+    Greedy,
+    // the matching with the minimal total distance between the enemies and the flowers
+    Optimal,
+};
 
 struct Config {
     Size field_size;
@@ -14,6 +22,7 @@ struct Config {
     std::pair<unsigned, unsigned> flower_scores_range;
     unsigned max_player_steps;
     unsigned min_player_scores;
+    EnemiesStrategy enemies_strategy = EnemiesStrategy::Greedy;
 };
 
 } // namespace logic
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace domain {
+
+// Vector of up to N elements kept inline, a larger one keeps all its elements on the heap.
+// A copy of a vector that fits N copies the inline array and allocates nothing.
+template<class T, size_t N>
+class SmallVector {
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+    explicit SmallVector(const size_t count) { resize(count); }
+    SmallVector(const SmallVector&) = default;
+    SmallVector& operator=(const SmallVector&) = default;
+    // The moved-from vector is left empty
+    SmallVector(SmallVector&& other) noexcept { moveFrom(other); }
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other) {
+            moveFrom(other);
+        }
+        return *this;
+    }
+    ~SmallVector() = default;
+
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] static constexpr size_t inlineCapacity() { return N; }
+
+    [[nodiscard]] T* data() { return size_ > N ? heap_.data() : inline_.data(); }
+    [[nodiscard]] const T* data() const { return size_ > N ? heap_.data() : inline_.data(); }
+    [[nodiscard]] T* begin() { return data(); }
+    [[nodiscard]] T* end() { return data() + size_; }
+    [[nodiscard]] const T* begin() const { return data(); }
+    [[nodiscard]] const T* end() const { return data() + size_; }
+    [[nodiscard]] T& operator[](const size_t i) { return data()[i]; }
+    [[nodiscard]] const T& operator[](const size_t i) const { return data()[i]; }
+
+    void clear() { resize(0); }
+
+    void resize(const size_t count)
+    {
+        if (count > N) {
+            if (size_ <= N) {
+                heap_.assign(inline_.begin(), inline_.begin() + size_);
+            }
+            heap_.resize(count);
+        } else if (size_ > N) {
+            // the spilled elements come back inline, the heap buffer is kept for the next spill
+            std::copy_n(heap_.begin(), count, inline_.begin());
+            heap_.clear();
+        } else {
+            // the new elements are value-initialized in place as std::vector does
+            for (auto i = size_; i < count; ++i) {
+                std::destroy_at(&inline_[i]);
+                std::construct_at(&inline_[i]);
+            }
+        }
+        size_ = count;
+    }
+
+    template<class... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (size_ < N) {
+            inline_[size_] = T(std::forward<Args>(args)...);
+            return inline_[size_++];
+        }
+        if (size_ == N) {
+            heap_.assign(inline_.begin(), inline_.end());
+        }
+        size_++;
+        return heap_.emplace_back(std::forward<Args>(args)...);
+    }
+    void push_back(const T& value) { emplace_back(value); }
+
+    template<std::input_iterator Iterator>
+    void assign(Iterator first, const Iterator last)
+    {
+        clear();
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    friend bool operator==(const SmallVector& a, const SmallVector& b) { return std::ranges::equal(a, b); }
+
+private:
+    std::array<T, N> inline_{};
+    // holds all the elements when there are more than N
+    std::vector<T> heap_;
+    size_t size_ = 0;
+
+    void moveFrom(SmallVector& other)
+    {
+        if (other.size_ > N) {
+            heap_ = std::move(other.heap_);
+        } else {
+            std::move(other.inline_.begin(), other.inline_.begin() + other.size_, inline_.begin());
+            heap_.clear();
+        }
+        size_ = std::exchange(other.size_, 0);
+        other.heap_.clear();
+    }
+};
+
+} // namespace domain
@@ -1,21 +1,30 @@
 #pragma once
+#include "domain/small_vector.h"
 #include "domain/units.h"
 
-#include <vector>
+#include <cstddef>
+#include <span>
 
 namespace domain {
 
-struct Player {
-    Position position;
+// The inline capacities cover the default config, the states of the larger ones keep the objects on the heap
+inline constexpr size_t inline_enemies = 8;
+inline constexpr size_t inline_flowers = 16;
+
+template<class T>
+struct BasicPlayer {
+    BasicPosition<T> position;
     unsigned scores;
     unsigned steps;
 };
-struct Flowers {
-    std::vector<Position> positions;
-    std::vector<unsigned> scores;
+template<class T>
+struct BasicFlowers {
+    SmallVector<BasicPosition<T>, inline_flowers> positions;
+    SmallVector<unsigned, inline_flowers> scores;
 };
-struct Enemies {
-    std::vector<Position> position;
+template<class T>
+struct BasicEnemies {
+    SmallVector<BasicPosition<T>, inline_enemies> position;
 };
 enum class GameStatus : uint8_t { PlayerTurn, EnemiesTurn, PlayerWon, PlayerLost };
 
@@ -29,12 +38,42 @@ enum SoundEffects : uint8_t {
     PlayerLost
 };
 
-struct State final {
-    Player player;
-    Enemies enemies;
-    Flowers flowers;
+template<class T>
+struct BasicState final {
+    BasicPlayer<T> player;
+    BasicEnemies<T> enemies;
+    BasicFlowers<T> flowers;
     GameStatus game_status;
     SoundEffects sound_effects{None};
 };
 
+// Non-owning view of a state: domain::BasicState or another state with the same members, StaticState for one.
+// It is valid while the state lives and is not resized.
+template<class T>
+struct BasicStateView {
+    BasicPlayer<T> player;
+    std::span<const BasicPosition<T>> enemies;
+    std::span<const BasicPosition<T>> flowers;
+    std::span<const unsigned> flowers_scores;
+    GameStatus game_status;
+    SoundEffects sound_effects;
+
+    template<class State>
+    explicit BasicStateView(const State& state)
+        : player(state.player)
+        , enemies(state.enemies.position)
+        , flowers(state.flowers.positions)
+        , flowers_scores(state.flowers.scores)
+        , game_status(state.game_status)
+        , sound_effects(state.sound_effects)
+    {
+    }
+};
+
+using Player = BasicPlayer<Scalar>;
+using Flowers = BasicFlowers<Scalar>;
+using Enemies = BasicEnemies<Scalar>;
+using State = BasicState<Scalar>;
+using StateView = BasicStateView<Scalar>;
+
 } // namespace domain
@@ -0,0 +1,75 @@
+#pragma once
+#include "domain/small_vector.h"
+#include "domain/state.h"
+
+#include <cstdint>
+
+namespace domain {
+
+template<class T>
+struct BasicEnemyMove {
+    uint32_t index;
+    BasicPosition<T> from;
+    BasicPosition<T> to;
+};
+
+// A flower eaten by the player or an enemy and placed again
+template<class T>
+struct BasicFlowerRespawn {
+    uint32_t index;
+    BasicPosition<T> from;
+    BasicPosition<T> to;
+    unsigned old_score;
+    unsigned new_score;
+};
+
+// Everything a move changed in the state. The enemies and the flowers that stayed in place are not listed,
+// the respawns go in the order they happened, so a flower may be listed twice.
+template<class T>
+struct BasicStepDelta {
+    BasicPlayer<T> player_from;
+    BasicPlayer<T> player_to;
+    SmallVector<BasicEnemyMove<T>, inline_enemies> enemies;
+    SmallVector<BasicFlowerRespawn<T>, 4> flowers;
+    GameStatus status_from;
+    GameStatus status_to;
+    SoundEffects sound_effects;
+};
+
+// Turns the state before the move into the state after it
+template<class State, class T>
+void applyStep(State& state, const BasicStepDelta<T>& step)
+{
+    state.player = step.player_to;
+    for (const auto& enemy: step.enemies) {
+        state.enemies.position[enemy.index] = enemy.to;
+    }
+    for (const auto& flower: step.flowers) {
+        state.flowers.positions[flower.index] = flower.to;
+        state.flowers.scores[flower.index] = flower.new_score;
+    }
+    state.game_status = step.status_to;
+    state.sound_effects = step.sound_effects;
+}
+
+// Turns the state after the move back into the state before it, but the sound effects
+template<class State, class T>
+void revertStep(State& state, const BasicStepDelta<T>& step)
+{
+    state.player = step.player_from;
+    for (const auto& enemy: step.enemies) {
+        state.enemies.position[enemy.index] = enemy.from;
+    }
+    for (auto flower = step.flowers.end(); flower != step.flowers.begin();) {
+        --flower;
+        state.flowers.positions[flower->index] = flower->from;
+        state.flowers.scores[flower->index] = flower->old_score;
+    }
+    state.game_status = step.status_from;
+}
+
+using EnemyMove = BasicEnemyMove<Scalar>;
+using FlowerRespawn = BasicFlowerRespawn<Scalar>;
+using StepDelta = BasicStepDelta<Scalar>;
+
+} // namespace domain
@@ -4,8 +4,14 @@
 
 namespace domain {
 
+// Coordinates type is a template parameter of the state and the engines, int8_t is enough for 127x127 boards
+template<class T>
+using BasicPosition = Eigen::Matrix<T, 2, 1>;
+template<class T>
+using BasicVector = Eigen::Matrix<T, 2, 1>;
+
 using Scalar = int8_t;
-using Position = Eigen::Matrix<Scalar, 2, 1>;
-using Vector = Eigen::Matrix<Scalar, 2, 1>;
+using Position = BasicPosition<Scalar>;
+using Vector = BasicVector<Scalar>;
 
 }
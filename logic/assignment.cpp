@@ -0,0 +1,159 @@
+#include "logic/assignment.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace logic::internal {
+
+void AssignmentSolver::run(WarmState& warm, const std::span<const int> row_keys, const int columns)
+{
+    rows_ = static_cast<int>(row_keys.size());
+    row_column_.assign(columns, -1);
+    column_row_.assign(columns, -1);
+    if (rows_ == 0) {
+        return;
+    }
+    zero_costs_.resize(columns);
+    if (std::ssize(warm.prices) != columns) {
+        warm.prices.assign(columns, 0);
+        warm.column_keys.assign(columns, -1);
+    }
+
+    // the pairs of the previous solve whose rows are still there, the dummy rows take the columns of the dummy ones
+    key_rows_.resize(std::max<size_t>(key_rows_.size(), *std::ranges::max_element(row_keys) + 1), -1);
+    for (int row = 0; row < rows_; ++row) {
+        key_rows_[row_keys[row]] = row;
+    }
+    auto dummy_row = rows_;
+    for (int column = 0; column < columns; ++column) {
+        const auto key = warm.column_keys[column];
+        auto row = -1;
+        if (key < 0) {
+            row = dummy_row < columns ? dummy_row++ : -1;
+        } else if (key < std::ssize(key_rows_)) {
+            row = key_rows_[key];
+        }
+        if (row >= 0) {
+            row_column_[row] = column;
+            column_row_[column] = row;
+        }
+    }
+    for (const auto key: row_keys) {
+        key_rows_[key] = -1;
+    }
+    keepTightPairs(warm, columns);
+
+    for (int row = 0; row < columns; ++row) {
+        if (row_column_[row] < 0) {
+            augment(warm, row, columns);
+        }
+    }
+    for (int column = 0; column < columns; ++column) {
+        const auto row = column_row_[column];
+        warm.column_keys[column] = row < rows_ ? row_keys[row] : -1;
+    }
+    // only the price differences matter, keep them from drifting turn after turn
+    const auto max_price = *std::ranges::max_element(warm.prices);
+    for (auto& price: warm.prices) {
+        price -= max_price;
+    }
+}
+
+void AssignmentSolver::keepTightPairs(const WarmState& warm, const int columns)
+{
+    const auto& prices = warm.prices;
+    // the cheapest column of the dummy rows is the most expensive one
+    const auto dummy_cheapest = -*std::ranges::max_element(prices);
+    for (int row = 0; row < columns; ++row) {
+        const auto column = row_column_[row];
+        if (column < 0) {
+            continue;
+        }
+        const auto* costs = rowCosts(row, columns);
+        auto cheapest = dummy_cheapest;
+        if (row < rows_) {
+            cheapest = std::numeric_limits<int>::max();
+            for (int j = 0; j < columns; ++j) {
+                cheapest = std::min(cheapest, costs[j] - prices[j]);
+            }
+        }
+        if (costs[column] - prices[column] != cheapest) {
+            unassign(row);
+        }
+    }
+}
+
+const int* AssignmentSolver::rowCosts(const int row, const int columns) const
+{
+    return row < rows_ ? costs_.data() + static_cast<size_t>(row) * columns : zero_costs_.data();
+}
+
+void AssignmentSolver::unassign(const int row)
+{
+    column_row_[row_column_[row]] = -1;
+    row_column_[row] = -1;
+}
+
+void AssignmentSolver::augment(WarmState& warm, const int row, const int columns)
+{
+    // a scanned column is out of the search, its shift keeps its key above the others
+    constexpr auto scanned_shift = std::numeric_limits<int>::max() / 4;
+    auto& prices = warm.prices;
+    keys_.resize(columns);
+    shifts_.resize(columns);
+    predecessors_.resize(columns);
+    scanned_.clear();
+    scanned_distances_.clear();
+
+    // the key of a column is twice its distance plus one for an assigned column, so a free column wins the ties
+    const auto* costs = rowCosts(row, columns);
+    for (int column = 0; column < columns; ++column) {
+        shifts_[column] = -prices[column];
+        keys_[column] = 2 * (costs[column] - prices[column]) + (column_row_[column] >= 0 ? 1 : 0);
+        predecessors_[column] = -1;
+    }
+    int sink = -1;
+    while (true) {
+        auto min_key = std::numeric_limits<int>::max();
+        for (int j = 0; j < columns; ++j) {
+            min_key = std::min(min_key, keys_[j]);
+        }
+        const auto column = static_cast<int>(std::ranges::find(keys_, min_key) - keys_.begin());
+        const auto distance = min_key >> 1;
+        const auto tree_row = column_row_[column];
+        if (tree_row < 0) {
+            sink = column;
+            break;
+        }
+        scanned_.push_back(column);
+        scanned_distances_.push_back(distance);
+        shifts_[column] = scanned_shift;
+        keys_[column] = scanned_shift;
+        // the distances through the row assigned to the column, its reduced costs are non-negative
+        const auto* tree_costs = rowCosts(tree_row, columns);
+        const auto base = distance - (tree_costs[column] - prices[column]);
+        for (int j = 0; j < columns; ++j) {
+            const auto key = 2 * (base + tree_costs[j] + shifts_[j]) + (keys_[j] & 1);
+            const auto closer = key < keys_[j];
+            keys_[j] = closer ? key : keys_[j];
+            predecessors_[j] = closer ? column : predecessors_[j];
+        }
+    }
+    // the scanned columns get cheaper, so the pairs along the path and the tree stay the cheapest ones of their rows
+    const auto sink_distance = keys_[sink] >> 1;
+    for (size_t i = 0; i < scanned_.size(); ++i) {
+        prices[scanned_[i]] -= sink_distance - scanned_distances_[i];
+    }
+    for (auto column = sink;;) {
+        const auto from = predecessors_[column];
+        const auto path_row = from < 0 ? row : column_row_[from];
+        column_row_[column] = path_row;
+        row_column_[path_row] = column;
+        if (from < 0) {
+            break;
+        }
+        column = from;
+    }
+}
+
+} // namespace logic::internal
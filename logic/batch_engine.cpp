@@ -0,0 +1,288 @@
+#include "logic/batch_engine.h"
+#include "distance.h"
+#include "rules.h"
+
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace logic {
+
+using ObjectType = internal::ObjectMap::ObjectType;
+
+template<class Scalar>
+BasicBatchEngine<Scalar>::BasicBatchEngine(const domain::Config& config, const size_t games, const uint64_t seed)
+    : config_(config)
+    , games_(games)
+    , enemies_(config.number_of_enemies)
+    , flowers_(config.number_of_flowers)
+    , score_generator_(config_.flower_scores_range.first, config_.flower_scores_range.second)
+    , player_x_(games_)
+    , player_y_(games_)
+    , scores_(games_)
+    , steps_(games_)
+    , enemies_x_(games_ * enemies_)
+    , enemies_y_(games_ * enemies_)
+    , flowers_x_(games_ * flowers_)
+    , flowers_y_(games_ * flowers_)
+    , flowers_scores_(games_ * flowers_)
+    , status_(games_, domain::GameStatus::PlayerTurn)
+    , rewards_(games_)
+    , target_x_(games_)
+    , target_y_(games_)
+    , target_inside_(games_)
+    , flowers_order_(flowers_)
+    , enemy_assigned_(enemies_)
+{
+    if (config_.field_size.maxCoeff() > std::numeric_limits<Scalar>::max()) {
+        throw std::invalid_argument("The field is too large for the engine coordinates type");
+    }
+    if (config_.enemies_strategy == domain::EnemiesStrategy::Optimal) {
+        assignment_states_.resize(games_);
+    }
+    rngs_.reserve(games_);
+    objects_maps_.reserve(games_);
+    flowers_buckets_.reserve(games_);
+    for (size_t game = 0; game < games_; ++game) {
+        rngs_.emplace_back(seed + game);
+        objects_maps_.emplace_back(config_.field_size[0], config_.field_size[1]);
+        flowers_buckets_.emplace_back(config_.field_size[0], config_.field_size[1], static_cast<int>(flowers_));
+        startGame(game);
+    }
+}
+
+template<class Scalar>
+std::span<const Scalar> BasicBatchEngine<Scalar>::getEnemiesX(const size_t game) const
+{
+    return std::span(enemies_x_).subspan(game * enemies_, enemies_);
+}
+
+template<class Scalar>
+std::span<const Scalar> BasicBatchEngine<Scalar>::getEnemiesY(const size_t game) const
+{
+    return std::span(enemies_y_).subspan(game * enemies_, enemies_);
+}
+
+template<class Scalar>
+std::span<const Scalar> BasicBatchEngine<Scalar>::getFlowersX(const size_t game) const
+{
+    return std::span(flowers_x_).subspan(game * flowers_, flowers_);
+}
+
+template<class Scalar>
+std::span<const Scalar> BasicBatchEngine<Scalar>::getFlowersY(const size_t game) const
+{
+    return std::span(flowers_y_).subspan(game * flowers_, flowers_);
+}
+
+template<class Scalar>
+std::span<const unsigned> BasicBatchEngine<Scalar>::getFlowersScores(const size_t game) const
+{
+    return std::span(flowers_scores_).subspan(game * flowers_, flowers_);
+}
+
+template<class Scalar>
+typename BasicBatchEngine<Scalar>::State BasicBatchEngine<Scalar>::getState(const size_t game) const
+{
+    State state;
+    state.player = {{player_x_[game], player_y_[game]}, scores_[game], steps_[game]};
+    for (size_t i = 0; i < enemies_; ++i) {
+        state.enemies.position.emplace_back(enemies_x_[game * enemies_ + i], enemies_y_[game * enemies_ + i]);
+    }
+    for (size_t i = 0; i < flowers_; ++i) {
+        state.flowers.positions.emplace_back(flowers_x_[game * flowers_ + i], flowers_y_[game * flowers_ + i]);
+    }
+    const auto scores = getFlowersScores(game);
+    state.flowers.scores.assign(scores.begin(), scores.end());
+    state.game_status = domain::GameStatus::PlayerTurn;
+    return state;
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::startGame(const size_t game)
+{
+    auto& objects_map = objects_maps_[game];
+    auto& rng = rngs_[game];
+    objects_map.clean();
+    scores_[game] = 0;
+    steps_[game] = 0;
+    const auto player = objects_map.placeObject(ObjectType::Player, 0, rng);
+    player_x_[game] = static_cast<Scalar>(player[0]);
+    player_y_[game] = static_cast<Scalar>(player[1]);
+    for (size_t i = game * enemies_; i < (game + 1) * enemies_; ++i) {
+        const auto enemy = objects_map.placeObject(ObjectType::Enemy, static_cast<int>(i - game * enemies_), rng);
+        enemies_x_[i] = static_cast<Scalar>(enemy[0]);
+        enemies_y_[i] = static_cast<Scalar>(enemy[1]);
+    }
+    flowers_buckets_[game].clear(player[0], player[1]);
+    for (size_t i = game * flowers_; i < (game + 1) * flowers_; ++i) {
+        const auto flower = objects_map.placeObject(ObjectType::Flower, static_cast<int>(i - game * flowers_), rng);
+        flowers_x_[i] = static_cast<Scalar>(flower[0]);
+        flowers_y_[i] = static_cast<Scalar>(flower[1]);
+        flowers_buckets_[game].insert(static_cast<int>(i - game * flowers_), flower[0], flower[1]);
+    }
+    for (size_t i = game * flowers_; i < (game + 1) * flowers_; ++i) {
+        flowers_scores_[i] = score_generator_.generate(rng);
+    }
+    if (!assignment_states_.empty()) {
+        assignment_states_[game].clear();
+    }
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::step(const Vector* moves)
+{
+    const auto width = config_.field_size[0];
+    const auto height = config_.field_size[1];
+    for (size_t game = 0; game < games_; ++game) {
+        const auto x = static_cast<Scalar>(player_x_[game] + moves[game][0]);
+        const auto y = static_cast<Scalar>(player_y_[game] + moves[game][1]);
+        target_x_[game] = x;
+        target_y_[game] = y;
+        target_inside_[game] = (x >= 0) & (x < width) & (y >= 0) & (y < height);
+    }
+    std::ranges::fill(rewards_, 0);
+    std::ranges::fill(status_, domain::GameStatus::PlayerTurn);
+
+    for (size_t game = 0; game < games_; ++game) {
+        if (!target_inside_[game]) {
+            continue;
+        }
+        movePlayer(game);
+        if (status_[game] != domain::GameStatus::EnemiesTurn) {
+            continue;
+        }
+        if (scores_[game] >= config_.min_player_scores) {
+            status_[game] = domain::GameStatus::PlayerWon;
+        } else if (steps_[game] >= config_.max_player_steps) {
+            status_[game] = domain::GameStatus::PlayerLost;
+        } else {
+            moveEnemies(game);
+            status_[game] = domain::GameStatus::PlayerTurn;
+            continue;
+        }
+        startGame(game);
+    }
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::movePlayer(const size_t game)
+{
+    const Position new_pos{target_x_[game], target_y_[game]};
+    auto& objects_map = objects_maps_[game];
+    switch (objects_map.getType(new_pos)) {
+    case ObjectType::Empty:
+        movePlayerTo(game, new_pos);
+        break;
+    case ObjectType::Player:
+        throw std::logic_error("seconds player!");
+    case ObjectType::Enemy:
+    case ObjectType::Wall:
+        return;
+    case ObjectType::Flower: {
+        const auto flower_index = game * flowers_ + objects_map.getId(new_pos);
+        movePlayerTo(game, new_pos);
+        rewards_[game] = flowers_scores_[flower_index];
+        scores_[game] += flowers_scores_[flower_index];
+        placeFlower(game, flower_index);
+        break;
+    }
+    }
+    status_[game] = domain::GameStatus::EnemiesTurn;
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::movePlayerTo(const size_t game, const Position& new_pos)
+{
+    auto& objects_map = objects_maps_[game];
+    objects_map.setType(player_x_[game], player_y_[game], ObjectType::Empty);
+    player_x_[game] = new_pos[0];
+    player_y_[game] = new_pos[1];
+    objects_map.setType(new_pos, ObjectType::Player);
+    steps_[game]++;
+    flowers_buckets_[game].moveCenter(new_pos[0], new_pos[1]);
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::placeFlower(const size_t game, const size_t index)
+{
+    const auto flower = objects_maps_[game].placeObject(
+        ObjectType::Flower, static_cast<int>(index - game * flowers_), rngs_[game]);
+    flowers_x_[index] = static_cast<Scalar>(flower[0]);
+    flowers_y_[index] = static_cast<Scalar>(flower[1]);
+    flowers_scores_[index] = score_generator_.generate(rngs_[game]);
+    flowers_buckets_[game].move(static_cast<int>(index - game * flowers_), flower[0], flower[1]);
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::selectThreatenedFlowers(const size_t game, const int count)
+{
+    std::ranges::copy(flowers_buckets_[game].kNearest(count), flowers_order_.begin());
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::moveEnemies(const size_t game)
+{
+    const auto* flowers_x = flowers_x_.data() + game * flowers_;
+    const auto* flowers_y = flowers_y_.data() + game * flowers_;
+    const auto* enemies_x = enemies_x_.data() + game * enemies_;
+    const auto* enemies_y = enemies_y_.data() + game * enemies_;
+    const auto flowers_to_handle = std::min(enemies_, flowers_);
+    selectThreatenedFlowers(game, static_cast<int>(flowers_to_handle));
+
+    if (!assignment_states_.empty()) {
+        const auto enemies = assignment_.solve(
+            assignment_states_[game],
+            std::span(flowers_order_).first(flowers_to_handle),
+            static_cast<int>(enemies_),
+            [&](const int flower, const int enemy) {
+                const auto f = flowers_order_[flower];
+                return std::max(std::abs(flowers_x[f] - enemies_x[enemy]), std::abs(flowers_y[f] - enemies_y[enemy]));
+            });
+        for (size_t i = 0; i < flowers_to_handle; i++) {
+            const auto flower = flowers_order_[i];
+            forwardEnemy(game, game * enemies_ + enemies[i], {flowers_x[flower], flowers_y[flower]});
+        }
+        return;
+    }
+
+    std::ranges::fill(enemy_assigned_, false);
+    for (size_t i = 0; i < flowers_to_handle; i++) {
+        const int flower_x = flowers_x[flowers_order_[i]];
+        const int flower_y = flowers_y[flowers_order_[i]];
+        const auto min_enemy = static_cast<size_t>(internal::chebyshevArgmin<Scalar>(
+            {enemies_x, enemies_}, {enemies_y, enemies_}, flower_x, flower_y, enemy_assigned_));
+        enemy_assigned_[min_enemy] = true;
+        forwardEnemy(
+            game,
+            game * enemies_ + min_enemy,
+            {static_cast<Scalar>(flower_x), static_cast<Scalar>(flower_y)});
+    }
+}
+
+template<class Scalar>
+void BasicBatchEngine<Scalar>::forwardEnemy(const size_t game, const size_t enemy_index, const Position& flower)
+{
+    auto& objects_map = objects_maps_[game];
+    const Position enemy{enemies_x_[enemy_index], enemies_y_[enemy_index]};
+    const auto step = internal::findEnemyStep<Scalar>(objects_map, config_.field_size, enemy, flower);
+    if (!step) {
+        return;
+    }
+    const auto flower_index = game * flowers_ + objects_map.getId(step->position);
+    objects_map.setType(enemy, ObjectType::Empty);
+    objects_map.setType(step->position, ObjectType::Enemy, static_cast<int>(enemy_index - game * enemies_));
+    enemies_x_[enemy_index] = step->position[0];
+    enemies_y_[enemy_index] = step->position[1];
+    if (step->place == ObjectType::Flower) {
+        placeFlower(game, flower_index);
+    }
+}
+
+template class BasicBatchEngine<int8_t>;
+template class BasicBatchEngine<int16_t>;
+template class BasicBatchEngine<int32_t>;
+
+} // namespace logic
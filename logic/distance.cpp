@@ -0,0 +1,249 @@
+#include "distance.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LOGIC_DISTANCE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOGIC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define LOGIC_TARGET(isa)
+#endif
+
+namespace logic::internal {
+
+namespace {
+
+constexpr int excluded_distance = std::numeric_limits<int>::max();
+
+// Continues the search from begin with the best point found so far.
+template<class Scalar>
+void argminScalar(
+    const Scalar* xs,
+    const Scalar* ys,
+    size_t begin,
+    const size_t n,
+    const int x,
+    const int y,
+    const uint8_t* excluded,
+    ptrdiff_t& best,
+    int& best_distance)
+{
+    for (; begin < n; ++begin) {
+        const auto d = std::max(std::abs(xs[begin] - x), std::abs(ys[begin] - y));
+        if (!excluded[begin] && d < best_distance) {
+            best_distance = d;
+            best = static_cast<ptrdiff_t>(begin);
+        }
+    }
+}
+
+// Picks the best of the per-lane minimums, the lanes hold disjoint index sets.
+template<size_t Lanes>
+void reduceLanes(const int (&lane_distance)[Lanes], const int (&lane_index)[Lanes], ptrdiff_t& best, int& best_distance)
+{
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        const auto d = lane_distance[lane];
+        if (d < best_distance || (d == best_distance && d != excluded_distance && lane_index[lane] < best)) {
+            best_distance = d;
+            best = lane_index[lane];
+        }
+    }
+}
+
+#if defined(LOGIC_DISTANCE_X86)
+
+enum class Isa { Scalar, Sse41, Avx2 };
+
+Isa detectIsa()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Isa::Sse41;
+    }
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    if (os_avx && max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 5)) != 0) {
+            return Isa::Avx2;
+        }
+    }
+    if (sse41) {
+        return Isa::Sse41;
+    }
+#endif
+    return Isa::Scalar;
+}
+
+Isa supportedIsa()
+{
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+// Four coordinates sign-extended to 32-bit lanes.
+template<class Scalar>
+LOGIC_TARGET("sse4.1") __m128i load4(const Scalar* p)
+{
+    if constexpr (sizeof(Scalar) == 1) {
+        int32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(bytes));
+    } else if constexpr (sizeof(Scalar) == 2) {
+        return _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    } else {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+}
+
+template<class Scalar>
+LOGIC_TARGET("sse4.1") __m128i distances4(const Scalar* xs, const Scalar* ys, const __m128i x, const __m128i y)
+{
+    const auto dx = _mm_abs_epi32(_mm_sub_epi32(load4(xs), x));
+    const auto dy = _mm_abs_epi32(_mm_sub_epi32(load4(ys), y));
+    return _mm_max_epi32(dx, dy);
+}
+
+template<class Scalar>
+LOGIC_TARGET("sse4.1")
+ptrdiff_t argminSse41(
+    const Scalar* xs, const Scalar* ys, const size_t n, const int x, const int y, const uint8_t* excluded)
+{
+    const auto vx = _mm_set1_epi32(x);
+    const auto vy = _mm_set1_epi32(y);
+    const auto excluded_value = _mm_set1_epi32(excluded_distance);
+    auto best_distance = excluded_value;
+    auto best_index = _mm_set1_epi32(-1);
+    auto index = _mm_setr_epi32(0, 1, 2, 3);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32_t flags;
+        std::memcpy(&flags, excluded + i, sizeof(flags));
+        const auto skip = _mm_cmpgt_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(flags)), _mm_setzero_si128());
+        const auto d = _mm_blendv_epi8(distances4(xs + i, ys + i, vx, vy), excluded_value, skip);
+        // strictly closer only, so every lane keeps its lowest index among the equal distances
+        const auto closer = _mm_cmplt_epi32(d, best_distance);
+        best_distance = _mm_blendv_epi8(best_distance, d, closer);
+        best_index = _mm_blendv_epi8(best_index, index, closer);
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+    }
+    int lane_distance[4];
+    int lane_index[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_distance), best_distance);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_index), best_index);
+    ptrdiff_t best = -1;
+    int best_d = excluded_distance;
+    reduceLanes(lane_distance, lane_index, best, best_d);
+    argminScalar(xs, ys, i, n, x, y, excluded, best, best_d);
+    return best;
+}
+
+// Eight coordinates sign-extended to 32-bit lanes.
+template<class Scalar>
+LOGIC_TARGET("avx2") __m256i load8(const Scalar* p)
+{
+    if constexpr (sizeof(Scalar) == 1) {
+        return _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    } else if constexpr (sizeof(Scalar) == 2) {
+        return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    } else {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+}
+
+template<class Scalar>
+LOGIC_TARGET("avx2") __m256i distances8(const Scalar* xs, const Scalar* ys, const __m256i x, const __m256i y)
+{
+    const auto dx = _mm256_abs_epi32(_mm256_sub_epi32(load8(xs), x));
+    const auto dy = _mm256_abs_epi32(_mm256_sub_epi32(load8(ys), y));
+    return _mm256_max_epi32(dx, dy);
+}
+
+template<class Scalar>
+LOGIC_TARGET("avx2")
+ptrdiff_t argminAvx2(
+    const Scalar* xs, const Scalar* ys, const size_t n, const int x, const int y, const uint8_t* excluded)
+{
+    const auto vx = _mm256_set1_epi32(x);
+    const auto vy = _mm256_set1_epi32(y);
+    const auto excluded_value = _mm256_set1_epi32(excluded_distance);
+    auto best_distance = excluded_value;
+    auto best_index = _mm256_set1_epi32(-1);
+    auto index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const auto flags = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(excluded + i)));
+        const auto skip = _mm256_cmpgt_epi32(flags, _mm256_setzero_si256());
+        const auto d = _mm256_blendv_epi8(distances8(xs + i, ys + i, vx, vy), excluded_value, skip);
+        // strictly closer only, so every lane keeps its lowest index among the equal distances
+        const auto closer = _mm256_cmpgt_epi32(best_distance, d);
+        best_distance = _mm256_blendv_epi8(best_distance, d, closer);
+        best_index = _mm256_blendv_epi8(best_index, index, closer);
+        index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+    }
+    int lane_distance[8];
+    int lane_index[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_distance), best_distance);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_index), best_index);
+    ptrdiff_t best = -1;
+    int best_d = excluded_distance;
+    reduceLanes(lane_distance, lane_index, best, best_d);
+    argminScalar(xs, ys, i, n, x, y, excluded, best, best_d);
+    return best;
+}
+
+#endif
+
+} // namespace
+
+template<class Scalar>
+ptrdiff_t chebyshevArgmin(
+    const std::span<const Scalar> xs,
+    const std::span<const Scalar> ys,
+    const int x,
+    const int y,
+    const std::span<const uint8_t> excluded)
+{
+#if defined(LOGIC_DISTANCE_X86)
+    switch (supportedIsa()) {
+    case Isa::Avx2:
+        return argminAvx2(xs.data(), ys.data(), xs.size(), x, y, excluded.data());
+    case Isa::Sse41:
+        return argminSse41(xs.data(), ys.data(), xs.size(), x, y, excluded.data());
+    case Isa::Scalar:
+        break;
+    }
+#endif
+    ptrdiff_t best = -1;
+    int best_distance = excluded_distance;
+    argminScalar(xs.data(), ys.data(), 0, xs.size(), x, y, excluded.data(), best, best_distance);
+    return best;
+}
+
+template ptrdiff_t chebyshevArgmin<int8_t>(
+    std::span<const int8_t>, std::span<const int8_t>, int, int, std::span<const uint8_t>);
+template ptrdiff_t chebyshevArgmin<int16_t>(
+    std::span<const int16_t>, std::span<const int16_t>, int, int, std::span<const uint8_t>);
+template ptrdiff_t chebyshevArgmin<int32_t>(
+    std::span<const int32_t>, std::span<const int32_t>, int, int, std::span<const uint8_t>);
+
+} // namespace logic::internal
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace logic::internal {
+
+// Vectorized Chebyshev distance scans over the coordinates kept in separate x[] and y[] arrays.
+// The AVX2 or SSE4.1 kernel is chosen at runtime, other CPUs use the scalar loop.
+
+// Index of the point nearest to (x, y) among the ones with excluded[i] == 0, the lowest index among the equally
+// distant ones. Returns -1 if all the points are excluded.
+template<class Scalar>
+ptrdiff_t chebyshevArgmin(
+    std::span<const Scalar> xs, std::span<const Scalar> ys, int x, int y, std::span<const uint8_t> excluded);
+
+} // namespace logic::internal
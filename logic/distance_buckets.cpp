@@ -0,0 +1,240 @@
+#include "logic/distance_buckets.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+namespace logic::internal {
+
+DistanceBuckets::DistanceBuckets(const int width, const int height, const int count)
+    : width_(width)
+    , height_(height)
+    , x_(count)
+    , y_(count)
+    , bucket_(count, npos)
+    , side_(std::max(width, height))
+    , buckets_(4 * side_, count)
+    , occupied_((4 * side_ + 63) / 64)
+    , falling_(width + height - 1, count)
+    , rising_(width + height - 1, count)
+{
+    result_.reserve(count);
+}
+
+void DistanceBuckets::clear(const int x, const int y)
+{
+    for (auto* lists: {&buckets_, &falling_, &rising_}) {
+        std::ranges::fill(lists->heads, npos);
+    }
+    std::ranges::fill(occupied_, 0);
+    std::ranges::fill(bucket_, npos);
+    center_x_ = x;
+    center_y_ = y;
+}
+
+void DistanceBuckets::insert(const int id, const int x, const int y)
+{
+    x_[id] = x;
+    y_[id] = y;
+    link(id, bucketOf(x, y));
+    falling_.link(id, fallingOf(id));
+    rising_.link(id, risingOf(id));
+}
+
+void DistanceBuckets::move(const int id, const int x, const int y)
+{
+    if (bucket_[id] != npos) {
+        unlink(id);
+        falling_.unlink(id, fallingOf(id));
+        rising_.unlink(id, risingOf(id));
+    }
+    insert(id, x, y);
+}
+
+void DistanceBuckets::moveCenter(const int x, const int y)
+{
+    const auto dx = x - center_x_, dy = y - center_y_;
+    center_x_ = x;
+    center_y_ = y;
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+    if (std::abs(dx) > 1 || std::abs(dy) > 1) {
+        for (int id = 0; id < std::ssize(bucket_); ++id) {
+            if (bucket_[id] != npos) {
+                rebucket(id);
+            }
+        }
+        return;
+    }
+    // |dx| - |dy| of an entity changes by 2 at most, so only the entities with ||dx| - |dy|| <= 2 before the step
+    // may change the cone, these are on the diagonals within 2 of the ones through the previous center
+    const auto visit = [&](const Lists& lists, const int center_line) {
+        const auto first = std::max(center_line - 2, 0);
+        const auto last = std::min(center_line + 2, static_cast<int>(lists.heads.size()) - 1);
+        for (int line = first; line <= last; ++line) {
+            for (int id = lists.heads[line]; id != npos; id = lists.next[id]) {
+                rebucket(id);
+            }
+        }
+    };
+    visit(falling_, x - dx - (y - dy) + height_ - 1);
+    visit(rising_, x - dx + y - dy);
+}
+
+std::span<const int> DistanceBuckets::kNearest(const int k, const int margin)
+{
+    result_.clear();
+    if (k <= 0) {
+        return result_;
+    }
+    const int centers[] = {center_x_, center_x_, center_y_, center_y_};
+    // the distance of the k-th entity plus the margin once it is found
+    auto last_distance = side_;
+    for (int distance = 0;; ++distance) {
+        // skip the empty distances, the cones may have their nearest buckets at different ones
+        int buckets[4];
+        auto nearest = side_;
+        for (int cone = Right; cone <= Down; ++cone) {
+            const auto key = cone == Right || cone == Up ? centers[cone] + distance : centers[cone] - distance;
+            buckets[cone] = nearestBucket(static_cast<Cone>(cone), key);
+            if (buckets[cone] != npos) {
+                nearest = std::min(nearest, std::abs(buckets[cone] - cone * side_ - centers[cone]));
+            }
+        }
+        if (nearest == side_ || nearest > last_distance) {
+            break;
+        }
+        distance = nearest;
+        // merge the sorted buckets at the distance, up to the k-th entity without a margin
+        int heads[4];
+        int lists = 0;
+        for (int cone = Right; cone <= Down; ++cone) {
+            if (buckets[cone] != npos && std::abs(buckets[cone] - cone * side_ - centers[cone]) == distance) {
+                heads[lists++] = buckets_.heads[buckets[cone]];
+            }
+        }
+        while (lists > 0 && (std::ssize(result_) < k || margin > 0)) {
+            int lowest = 0;
+            for (int i = 1; i < lists; ++i) {
+                lowest = heads[i] < heads[lowest] ? i : lowest;
+            }
+            result_.push_back(heads[lowest]);
+            heads[lowest] = buckets_.next[heads[lowest]];
+            if (heads[lowest] == npos) {
+                heads[lowest] = heads[--lists];
+            }
+        }
+        if (std::ssize(result_) >= k) {
+            if (margin == 0) {
+                break;
+            }
+            last_distance = std::min(last_distance, distance + margin);
+        }
+    }
+    return result_;
+}
+
+int DistanceBuckets::bucketOf(const int x, const int y) const
+{
+    const auto dx = x - center_x_, dy = y - center_y_;
+    if (std::abs(dx) >= std::abs(dy)) {
+        return (dx >= 0 ? Right : Left) * side_ + x;
+    }
+    return (dy > 0 ? Up : Down) * side_ + y;
+}
+
+void DistanceBuckets::link(const int id, const int bucket)
+{
+    buckets_.linkSorted(id, bucket);
+    bucket_[id] = bucket;
+    occupied_[bucket / 64] |= uint64_t{1} << (bucket % 64);
+}
+
+void DistanceBuckets::unlink(const int id)
+{
+    const auto bucket = bucket_[id];
+    buckets_.unlink(id, bucket);
+    if (buckets_.heads[bucket] == npos) {
+        occupied_[bucket / 64] &= ~(uint64_t{1} << (bucket % 64));
+    }
+    bucket_[id] = npos;
+}
+
+void DistanceBuckets::rebucket(const int id)
+{
+    if (const auto bucket = bucketOf(x_[id], y_[id]); bucket != bucket_[id]) {
+        unlink(id);
+        link(id, bucket);
+    }
+}
+
+int DistanceBuckets::nearestBucket(const Cone cone, const int key) const
+{
+    if (key < 0 || key >= side_) {
+        return npos;
+    }
+    const auto begin = cone * side_, end = begin + side_;
+    if (cone == Right || cone == Up) {
+        // the first set bit from the key up to the end of the cone
+        for (auto bit = begin + key; bit < end;) {
+            if (const auto word = occupied_[bit / 64] >> (bit % 64); word != 0) {
+                bit += std::countr_zero(word);
+                return bit < end ? bit : npos;
+            }
+            bit = (bit / 64 + 1) * 64;
+        }
+        return npos;
+    }
+    // the last set bit from the key down to the beginning of the cone
+    for (auto bit = begin + key; bit >= begin;) {
+        if (const auto word = occupied_[bit / 64] << (63 - bit % 64); word != 0) {
+            bit -= std::countl_zero(word);
+            return bit >= begin ? bit : npos;
+        }
+        bit = bit / 64 * 64 - 1;
+    }
+    return npos;
+}
+
+void DistanceBuckets::Lists::link(const int id, const int list)
+{
+    prev[id] = npos;
+    next[id] = heads[list];
+    if (next[id] != npos) {
+        prev[next[id]] = id;
+    }
+    heads[list] = id;
+}
+
+void DistanceBuckets::Lists::linkSorted(const int id, const int list)
+{
+    if (heads[list] == npos || heads[list] > id) {
+        link(id, list);
+        return;
+    }
+    auto after = heads[list];
+    while (next[after] != npos && next[after] < id) {
+        after = next[after];
+    }
+    prev[id] = after;
+    next[id] = next[after];
+    if (next[id] != npos) {
+        prev[next[id]] = id;
+    }
+    next[after] = id;
+}
+
+void DistanceBuckets::Lists::unlink(const int id, const int list)
+{
+    if (prev[id] != npos) {
+        next[prev[id]] = next[id];
+    } else {
+        heads[list] = next[id];
+    }
+    if (next[id] != npos) {
+        prev[next[id]] = prev[id];
+    }
+}
+
+} // namespace logic::internal
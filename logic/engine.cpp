@@ -1,163 +1,454 @@
 #include "logic/engine.h"
-// msvc 2022 does not implement mdspan[x,y]
-#define MDSPAN_USE_BRACKET_OPERATOR 0
-#include <experimental/mdspan>
+#include "rules.h"
+#include "zobrist.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 
 namespace logic {
 
 using ObjectType = internal::ObjectMap::ObjectType;
-using std::experimental::mdspan;
 
-internal::ObjectMap::ObjectMap(int width, int height)
-    : width_(width)
-    , height_(height)
-    , rng_(std::random_device()())
-    , objects_bitmap_(width_ * height_, ObjectType::Empty)
-{
-}
+namespace {
+    uint64_t randomSeed()
+    {
+        std::random_device device;
+        return (uint64_t{device()} << 32) | device();
+    }
 
-void internal::ObjectMap::clean()
-{
-    std::ranges::fill(objects_bitmap_, ObjectType::Empty);
-}
+    template<class Scalar>
+    domain::BasicVector<Scalar> moveDirection(const int i)
+    {
+        return {static_cast<Scalar>(move_directions[i][0]), static_cast<Scalar>(move_directions[i][1])};
+    }
 
-domain::Position internal::ObjectMap::placeObject(const ObjectType object)
-{
-    std::uniform_int_distribution<> x_gen(0, width_ - 1);
-    std::uniform_int_distribution<> y_gen(0, height_ - 1);
-    const auto objects = mdspan(objects_bitmap_.data(), width_, height_);
-    for (;;) {
-        auto x = x_gen(rng_);
-        auto y = y_gen(rng_);
-        if (objects(x, y) == ObjectType::Empty) {
-            objects(x, y) = object;
-            return {x, y};
+    // Bit i is set if the direction i stays in the field
+    uint8_t insideMask(const int x, const int y, const domain::Size& field_size)
+    {
+        uint8_t mask = 0xff;
+        if (x == field_size[0] - 1) {
+            mask &= ~0x83; // (1, -1), (1, 0), (1, 1)
+        }
+        if (y == field_size[1] - 1) {
+            mask &= ~0x0e; // (1, 1), (0, 1), (-1, 1)
+        }
+        if (x == 0) {
+            mask &= ~0x38; // (-1, 1), (-1, 0), (-1, -1)
+        }
+        if (y == 0) {
+            mask &= ~0xe0; // (-1, -1), (0, -1), (1, -1)
         }
+        return mask;
     }
-}
-
-ObjectType internal::ObjectMap::getType(domain::Position pos) const
-{
-    const auto objects = mdspan(objects_bitmap_.data(), width_, height_);
-    return objects(pos[0], pos[1]);
-}
+} // namespace
 
-void internal::ObjectMap::setType(domain::Position pos, ObjectType type)
+internal::ScoreGenerator::ScoreGenerator(const unsigned min, const unsigned max)
+    : min_(min)
+    , range_(max - min + 1)
 {
-    const auto objects = mdspan(objects_bitmap_.data(), width_, height_);
-    objects(pos[0], pos[1]) = type;
 }
 
-internal::ScoreGenerator::ScoreGenerator(const unsigned min, const unsigned max)
-    : rng_(std::random_device()())
-    , score_distribution_{min, max}
+unsigned internal::ScoreGenerator::generate(Random& rng) const
 {
+    return min_ + rng.uniform(range_);
 }
 
-unsigned internal::ScoreGenerator::generate()
+template<class Scalar, class Map>
+BasicEngine<Scalar, Map>::BasicEngine(const domain::Config& config)
+    : BasicEngine(config, randomSeed())
 {
-    return score_distribution_(rng_);
 }
 
-Engine::Engine(const domain::Config& config)
+template<class Scalar, class Map>
+BasicEngine<Scalar, Map>::BasicEngine(const domain::Config& config, const uint64_t seed)
     : config_(config)
+    , rng_(seed)
     , objects_map_(config_.field_size[0], config_.field_size[1])
     , score_generator_(config_.flower_scores_range.first, config_.flower_scores_range.second)
+    , flowers_buckets_(config_.field_size[0], config_.field_size[1], static_cast<int>(config_.number_of_flowers))
+    , enemies_index_(config_.field_size[0], config_.field_size[1], static_cast<int>(config_.number_of_enemies))
 {
+    if (config_.field_size.maxCoeff() > std::numeric_limits<Scalar>::max()) {
+        throw std::invalid_argument("The field is too large for the engine coordinates type");
+    }
     state_.enemies.position.resize(config_.number_of_enemies);
     state_.flowers.positions.resize(config_.number_of_flowers);
     state_.flowers.scores.resize(config_.number_of_flowers);
+    enemy_assigned_.resize(config_.number_of_enemies);
 }
 
-void Engine::startGame()
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::startGame()
 {
     objects_map_.clean();
 
     state_.player.scores = 0;
     state_.player.steps = 0;
-    state_.player.position = objects_map_.placeObject(ObjectType::Player);
+    state_.player.position = objects_map_.placeObject(ObjectType::Player, 0, rng_).template cast<Scalar>();
     state_.sound_effects = domain::SoundEffects::GameStarted;
 
-    std::ranges::generate(
-        state_.enemies.position,
-        std::bind_front(&internal::ObjectMap::placeObject, &objects_map_, ObjectType::Enemy));
-
-    std::ranges::generate(
-        state_.flowers.positions,
-        std::bind_front(&internal::ObjectMap::placeObject, &objects_map_, ObjectType::Flower));
+    enemies_index_.clear();
+    for (int i = 0; i < std::ssize(state_.enemies.position); ++i) {
+        const auto cell = objects_map_.placeObject(ObjectType::Enemy, i, rng_);
+        state_.enemies.position[i] = cell.template cast<Scalar>();
+        enemies_index_.insert(i, cell[0], cell[1]);
+    }
+    flowers_buckets_.clear(state_.player.position[0], state_.player.position[1]);
+    for (int i = 0; i < std::ssize(state_.flowers.positions); ++i) {
+        const auto cell = objects_map_.placeObject(ObjectType::Flower, i, rng_);
+        state_.flowers.positions[i] = cell.template cast<Scalar>();
+        flowers_buckets_.insert(i, cell[0], cell[1]);
+    }
     std::ranges::generate(
         state_.flowers.scores,
-        std::bind_front(&internal::ScoreGenerator::generate, &score_generator_));
+        [this] { return score_generator_.generate(rng_); });
+    assignment_state_.clear();
+    plies_begin_ = plies_cursor_ = plies_end_ = 0;
+
+    hash_ = internal::zobrist::cellKey(cellNumber(state_.player.position), ObjectType::Player) ^
+        internal::zobrist::playerKey(state_.player.steps, state_.player.scores);
+    for (const auto& position: state_.enemies.position) {
+        hash_ ^= internal::zobrist::cellKey(cellNumber(position), ObjectType::Enemy);
+    }
+    for (size_t i = 0; i < state_.flowers.positions.size(); ++i) {
+        hash_ ^= internal::zobrist::flowerKey(cellNumber(state_.flowers.positions[i]), state_.flowers.scores[i]);
+    }
 
     state_.game_status = domain::GameStatus::PlayerTurn;
 }
 
-void Engine::move(const domain::Vector& direction)
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::startGame(const uint64_t seed)
+{
+    rng_.reseed(seed);
+    startGame();
+}
+
+template<class Scalar, class Map>
+const typename BasicEngine<Scalar, Map>::StepDelta& BasicEngine<Scalar, Map>::move(const Vector& direction)
+{
+    plies_end_ = plies_cursor_;
+    return play(direction);
+}
+
+template<class Scalar, class Map>
+const typename BasicEngine<Scalar, Map>::StepDelta& BasicEngine<Scalar, Map>::play(const Vector& direction)
 {
+    Ply* ply = nullptr;
+    if (!plies_.empty()) {
+        if (plies_cursor_ - plies_begin_ == plies_.size()) {
+            plies_begin_++; // the oldest ply makes room
+        }
+        ply = &plies_[plies_cursor_ % plies_.size()];
+    }
+    makeMove(direction, ply);
+    if (ply) {
+        plies_cursor_++;
+        plies_end_ = std::max(plies_end_, plies_cursor_);
+    }
+    return step_;
+}
+
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::makeMove(const Vector& direction, Ply* ply)
+{
+    if (ply) {
+        ply->direction = direction;
+        ply->rng = rng_.getState();
+        ply->sound_effects = state_.sound_effects;
+        ply->hash = hash_;
+        ply->cells.clear();
+        if (config_.enemies_strategy == domain::EnemiesStrategy::Optimal) {
+            ply->assignment = assignment_state_;
+        }
+    }
+    recording_ = ply;
+    step_.player_from = state_.player;
+    step_.status_from = state_.game_status;
+    step_.enemies.clear();
+    step_.flowers.clear();
     movePlayer(direction);
     if (state_.game_status == domain::GameStatus::EnemiesTurn) {
         moveEnemies();
     }
+    step_.player_to = state_.player;
+    step_.status_to = state_.game_status;
+    step_.sound_effects = state_.sound_effects;
+    if (ply) {
+        ply->step = step_;
+    }
+    recording_ = nullptr;
 }
 
-void Engine::movePlayer(const domain::Vector& direction)
+template<class Scalar, class Map>
+BasicEngine<Scalar, Map> BasicEngine<Scalar, Map>::fork() const
 {
-    state_.sound_effects = domain::SoundEffects::None;
-    domain::Position new_pos = state_.player.position + direction;
-    if (new_pos[0] < 0 || new_pos[0] >= config_.field_size[0] || new_pos[1] < 0 ||
-        new_pos[1] >= config_.field_size[1]) {
-        state_.sound_effects = domain::SoundEffects::PlayerCouldNotMove;
+    BasicEngine engine(config_, 0);
+    engine.restoreFrom(*this);
+    return engine;
+}
+
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::restoreFrom(const BasicEngine& other)
+{
+    if (&other.config_ != &config_) {
+        throw std::invalid_argument("The engines are made from different configs");
+    }
+    if (&other == this) {
         return;
     }
+    // the generator state goes with the position, so the restored engine places the flowers as the other one would
+    rng_ = other.rng_;
+    objects_map_ = other.objects_map_;
+    state_ = other.state_;
+    flowers_buckets_ = other.flowers_buckets_;
+    enemies_index_ = other.enemies_index_;
+    assignment_state_ = other.assignment_state_;
+    step_ = other.step_;
+    hash_ = other.hash_;
+    plies_begin_ = plies_cursor_ = plies_end_ = 0;
+}
+
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::setUndoDepth(const size_t plies)
+{
+    plies_.clear();
+    plies_.resize(plies);
+    plies_begin_ = plies_cursor_ = plies_end_ = 0;
+}
+
+template<class Scalar, class Map>
+bool BasicEngine<Scalar, Map>::undo()
+{
+    if (plies_cursor_ == plies_begin_) {
+        return false;
+    }
+    takeBack(plies_[--plies_cursor_ % plies_.size()]);
+    return true;
+}
 
-    switch (objects_map_.getType(new_pos)) {
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::takeBack(const Ply& ply)
+{
+    // backwards, so a cell that was emptied is the last one of the free cells list when it is filled again
+    // and a cell that was filled gets its free cells list slot back
+    for (const auto& cell: std::views::reverse(ply.cells)) {
+        if (cell.type == ObjectType::Empty) {
+            objects_map_.restoreEmpty(cell.x, cell.y, cell.slot);
+        } else {
+            objects_map_.setType(Position{cell.x, cell.y}, cell.type, cell.id);
+        }
+    }
+    domain::revertStep(state_, ply.step);
+    state_.sound_effects = ply.sound_effects;
+    hash_ = ply.hash;
+    for (const auto& enemy: ply.step.enemies) {
+        enemies_index_.move(static_cast<int>(enemy.index), enemy.from[0], enemy.from[1]);
+    }
+    for (const auto& flower: std::views::reverse(ply.step.flowers)) {
+        flowers_buckets_.move(static_cast<int>(flower.index), flower.from[0], flower.from[1]);
+    }
+    flowers_buckets_.moveCenter(state_.player.position[0], state_.player.position[1]);
+    rng_.setState(ply.rng);
+    if (config_.enemies_strategy == domain::EnemiesStrategy::Optimal) {
+        assignment_state_ = ply.assignment;
+    }
+}
+
+template<class Scalar, class Map>
+bool BasicEngine<Scalar, Map>::redo()
+{
+    if (plies_cursor_ == plies_end_) {
+        return false;
+    }
+    // the same direction from the same state and generator state makes the same move
+    const Vector direction = plies_[plies_cursor_ % plies_.size()].direction;
+    play(direction);
+    return true;
+}
+
+template<class Scalar, class Map>
+uint8_t BasicEngine<Scalar, Map>::legalMoves() const
+{
+    const auto& player = state_.player.position;
+    if constexpr (internal::NeighbourMap<Map>) {
+        // a word read per column, the player has no Player neighbour to step to
+        return insideMask(player[0], player[1], config_.field_size) &
+            static_cast<uint8_t>(~objects_map_.neighbours(player[0], player[1], ObjectType::Enemy));
+    } else if constexpr (internal::WalledMap<Map>) {
+        const auto index = objects_map_.index(player[0], player[1]);
+        uint8_t mask = 0;
+        for (int i = 0; i < std::ssize(move_directions); ++i) {
+            mask |= internal::isFreeForPlayer(objects_map_.typeAt(index + objects_map_.directionOffset(i))) << i;
+        }
+        return mask;
+    } else {
+        const auto inside = insideMask(player[0], player[1], config_.field_size);
+        uint8_t mask = 0;
+        for (int i = 0; i < std::ssize(move_directions); ++i) {
+            if ((inside >> i) & 1) {
+                const Position new_pos = player + moveDirection<Scalar>(i);
+                mask |= internal::isFreeForPlayer(objects_map_.getType(new_pos)) << i;
+            }
+        }
+        return mask;
+    }
+}
+
+template<class Scalar, class Map>
+const std::array<typename BasicEngine<Scalar, Map>::MoveOutcome, 8>& BasicEngine<Scalar, Map>::evaluateMoves(
+    const bool enemy_responses)
+{
+    const auto legal = legalMoves();
+    if (enemy_responses) {
+        last_step_ = step_;
+        prepareProbes();
+    }
+    for (int i = 0; i < std::ssize(move_directions); ++i) {
+        auto& outcome = outcomes_[i];
+        outcome.legal = ((legal >> i) & 1) != 0;
+        outcome.eats_flower = false;
+        outcome.score_delta = 0;
+        if (!outcome.legal) {
+            continue;
+        }
+        const auto direction = moveDirection<Scalar>(i);
+        const Position new_pos = state_.player.position + direction;
+        if (objects_map_.getType(new_pos) == ObjectType::Flower) {
+            outcome.eats_flower = true;
+            outcome.score_delta = state_.flowers.scores[objects_map_.getId(new_pos)];
+        }
+        if (enemy_responses) {
+            // the move is made and taken back as the journal does, the engine is left as it was
+            makeMove(direction, &probe_);
+            outcome.response = step_;
+            takeBack(probe_);
+        }
+    }
+    if (enemy_responses) {
+        step_ = last_step_;
+        probing_ = false;
+    }
+    return outcomes_;
+}
+
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::movePlayer(const Vector& direction)
+{
+    state_.sound_effects = domain::SoundEffects::None;
+    const Position new_pos = state_.player.position + direction;
+    // the Wall border stops the player without the bounds checks, the cell is probed by the index
+    [[maybe_unused]] int new_index = 0;
+    ObjectType place;
+    if constexpr (internal::WalledMap<Map>) {
+        new_index = objects_map_.index(state_.player.position[0], state_.player.position[1]) +
+            objects_map_.directionOffset(direction[0], direction[1]);
+        place = objects_map_.typeAt(new_index);
+    } else {
+        if (new_pos[0] < 0 || new_pos[0] >= config_.field_size[0] || new_pos[1] < 0 ||
+            new_pos[1] >= config_.field_size[1]) {
+            state_.sound_effects = domain::SoundEffects::PlayerCouldNotMove;
+            return;
+        }
+        place = objects_map_.getType(new_pos);
+    }
+
+    switch (place) {
     case ObjectType::Empty:
         movePlayerTo(new_pos);
         break;
     case ObjectType::Player:
         throw std::logic_error("seconds player!");
     case ObjectType::Enemy:
+    case ObjectType::Wall:
         state_.sound_effects = domain::SoundEffects::PlayerCouldNotMove;
         return;
-    case ObjectType::Flower:
+    case ObjectType::Flower: {
+        int flower_index;
+        if constexpr (internal::WalledMap<Map>) {
+            flower_index = objects_map_.idAt(new_index);
+        } else {
+            flower_index = objects_map_.getId(new_pos);
+        }
         movePlayerTo(new_pos);
-        eatFlowerByPlayer();
+        eatFlowerByPlayer(flower_index);
         break;
     }
+    }
     updateStatusAfterPlayerHasMoved();
 }
 
-void Engine::movePlayerTo(const domain::Position& new_pos)
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::movePlayerTo(const Position& new_pos)
 {
-    objects_map_.setType(state_.player.position, ObjectType::Empty);
+    hash_ ^= internal::zobrist::cellKey(cellNumber(state_.player.position), ObjectType::Player) ^
+        internal::zobrist::cellKey(cellNumber(new_pos), ObjectType::Player) ^
+        internal::zobrist::playerKey(state_.player.steps, state_.player.scores) ^
+        internal::zobrist::playerKey(state_.player.steps + 1, state_.player.scores);
+    setCell(state_.player.position, ObjectType::Empty);
     state_.player.position = new_pos;
-    objects_map_.setType(state_.player.position, ObjectType::Player);
+    setCell(state_.player.position, ObjectType::Player);
+    flowers_buckets_.moveCenter(new_pos[0], new_pos[1]);
     state_.player.steps++;
     state_.sound_effects = domain::SoundEffects::PlayerMoved;
 }
 
-void Engine::eatFlowerByPlayer()
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::setCell(const Position& pos, const ObjectType type, const int id)
 {
-    const auto index = getFlowerIndex(state_.player.position);
-    state_.player.scores += state_.flowers.scores[index];
-    state_.sound_effects = domain::SoundEffects::PlayerAteFlower;
-    placeFlower(index);
+    if (recording_) {
+        const auto old_type = objects_map_.getType(pos);
+        const auto slot = old_type == ObjectType::Empty ? objects_map_.freeSlot(pos[0], pos[1]) : 0;
+        recording_->cells.push_back({pos[0], pos[1], old_type, objects_map_.getId(pos), slot});
+    }
+    objects_map_.setType(pos, type, id);
 }
 
-ptrdiff_t Engine::getFlowerIndex(const domain::Position& pos) const
+template<class Scalar, class Map>
+int64_t BasicEngine<Scalar, Map>::cellNumber(const Position& pos) const
 {
-    return std::distance(state_.flowers.positions.begin(), std::ranges::find(state_.flowers.positions, pos));
+    return int64_t{pos[0]} * config_.field_size[1] + pos[1];
+}
+
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::eatFlowerByPlayer(const ptrdiff_t index)
+{
+    hash_ ^= internal::zobrist::playerKey(state_.player.steps, state_.player.scores) ^
+        internal::zobrist::playerKey(state_.player.steps, state_.player.scores + state_.flowers.scores[index]);
+    state_.player.scores += state_.flowers.scores[index];
+    state_.sound_effects = domain::SoundEffects::PlayerAteFlower;
+    placeFlower(index);
 }
 
-void Engine::placeFlower(const ptrdiff_t index)
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::placeFlower(const ptrdiff_t index)
 {
-    state_.flowers.positions[index] = objects_map_.placeObject(ObjectType::Flower);
-    state_.flowers.scores[index] = score_generator_.generate();
+    const auto cell = objects_map_.pickEmpty(rng_);
+    const Position old_position = state_.flowers.positions[index];
+    const auto old_score = state_.flowers.scores[index];
+    state_.flowers.positions[index] = cell.template cast<Scalar>();
+    setCell(state_.flowers.positions[index], ObjectType::Flower, static_cast<int>(index));
+    flowers_buckets_.move(static_cast<int>(index), cell[0], cell[1]);
+    state_.flowers.scores[index] = score_generator_.generate(rng_);
+    hash_ ^= internal::zobrist::flowerKey(cellNumber(old_position), old_score) ^
+        internal::zobrist::flowerKey(cellNumber(state_.flowers.positions[index]), state_.flowers.scores[index]);
+    step_.flowers.push_back(
+        {static_cast<uint32_t>(index),
+         old_position,
+         state_.flowers.positions[index],
+         old_score,
+         state_.flowers.scores[index]});
 }
 
-void Engine::updateStatusAfterPlayerHasMoved()
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::updateStatusAfterPlayerHasMoved()
 {
     if (state_.player.scores >= config_.min_player_scores) {
         state_.game_status = domain::GameStatus::PlayerWon;
@@ -170,93 +461,160 @@ void Engine::updateStatusAfterPlayerHasMoved()
     }
 }
 
-namespace {
-    std::vector<int> distanceBetween(const std::vector<domain::Position>& object, const domain::Position& pos)
-    {
-        std::vector<int> result(object.size());
-        std::ranges::transform(object, result.begin(), [pos](const domain::Position& p) -> int {
-            return (pos - p).array().abs().maxCoeff();
-        });
-        return result;
-    }
-} // namespace
-
-void Engine::moveEnemies()
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::prepareProbes()
 {
-    const auto distance = distanceBetween(state_.flowers.positions, state_.player.position);
-    std::vector<int> flowers(config_.number_of_flowers);
-    std::iota(flowers.begin(), flowers.end(), 0);
-    const auto flowers_to_handle = std::min(config_.number_of_enemies, config_.number_of_flowers);
-    std::ranges::partial_sort(flowers, flowers.begin() + flowers_to_handle, [&](const int i1, const int i2) {
-        return distance[i1] < distance[i2];
-    });
-
-    auto enemies = state_.enemies.position;
-    std::vector<int> enemies_indexes(enemies.size());
-    std::iota(enemies_indexes.begin(), enemies_indexes.end(), 0);
-
-    for (unsigned i = 0; i < flowers_to_handle; i++) {
-        const auto& flower_position = state_.flowers.positions[flowers[i]];
-        const auto enemies_distance = distanceBetween(enemies, flower_position);
-        const auto min_enemy = std::distance(enemies_distance.begin(), std::ranges::min_element(enemies_distance));
-
-        forwardEnemy(enemies_indexes[min_enemy], flower_position);
-
-        enemies.erase(enemies.begin() + min_enemy);
-        enemies_indexes.erase(enemies_indexes.begin() + min_enemy);
+    // a step changes a distance by one at most, so the flowers threatened after any step are at most 2 farther
+    // than the k-th nearest one now. The enemies stay where they are until the enemies turn.
+    const auto flowers_to_handle = static_cast<int>(std::min(config_.number_of_enemies, config_.number_of_flowers));
+    const auto flowers = flowers_buckets_.kNearest(flowers_to_handle, 2);
+    // the buffers are sized by the first call, so a fork does not allocate them
+    probe_flowers_.assign(flowers.begin(), flowers.end());
+    probing_ = true;
+    probes_ = 0;
+    if (config_.enemies_strategy != domain::EnemiesStrategy::Optimal) {
+        return; // the greedy strategy asks the enemies index, its nearest enemy is found without the distances
+    }
+    const auto enemies_count = static_cast<int>(config_.number_of_enemies);
+    probe_rows_.resize(config_.number_of_flowers);
+    probe_distances_.resize(probe_flowers_.size() * enemies_count);
+    auto* distances = probe_distances_.data();
+    for (int row = 0; row < std::ssize(probe_flowers_); ++row) {
+        const auto& flower_position = state_.flowers.positions[probe_flowers_[row]];
+        probe_rows_[probe_flowers_[row]] = row;
+        for (int enemy = 0; enemy < enemies_count; ++enemy) {
+            *distances++ = internal::distanceBetween(flower_position, state_.enemies.position[enemy]);
+        }
     }
-
-    state_.game_status = domain::GameStatus::PlayerTurn;
 }
 
-domain::Vector rotate45(const domain::Vector& vec)
+template<class Scalar, class Map>
+std::span<const int> BasicEngine<Scalar, Map>::selectProbeFlowers(const int count)
 {
-    const auto xNew = std::clamp<domain::Scalar>(vec[0] - vec[1], -1, 1);
-    const auto yNew = std::clamp<domain::Scalar>(vec[0] + vec[1], -1, 1);
-    return domain::Vector{xNew, yNew};
+    const auto flowers_count = static_cast<int64_t>(config_.number_of_flowers);
+    probe_keys_.clear();
+    for (const auto flower: probe_flowers_) {
+        const auto distance = internal::distanceBetween(state_.flowers.positions[flower], state_.player.position);
+        probe_keys_.push_back(distance * flowers_count + flower);
+    }
+    std::ranges::partial_sort(probe_keys_, probe_keys_.begin() + count);
+    probe_order_.clear();
+    for (int i = 0; i < count; ++i) {
+        probe_order_.push_back(static_cast<int>(probe_keys_[i] % flowers_count));
+    }
+    return probe_order_;
 }
 
-domain::Vector rotateNeg45(const domain::Vector& vec)
+template<class Scalar, class Map>
+std::span<const int> BasicEngine<Scalar, Map>::repeatedChoices(const std::span<const int> flowers) const
 {
-    const auto xNew = std::clamp<domain::Scalar>(vec[0] + vec[1], -1, 1);
-    const auto yNew = std::clamp<domain::Scalar>(-vec[0] + vec[1], -1, 1);
-    return domain::Vector{xNew, yNew};
+    std::span<const int> repeated;
+    for (int probe = 0; probe < probes_; ++probe) {
+        const auto& choices = probe_choices_[probe];
+        size_t same = 0;
+        while (same < choices.enemies.size() && choices.flowers[same] == flowers[same]) {
+            ++same;
+        }
+        if (same > repeated.size()) {
+            repeated = std::span(choices.enemies).first(same);
+        }
+    }
+    return repeated;
 }
 
-domain::Position Engine::clampPosition(const domain::Position& pos) const
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::moveEnemies()
 {
-    return {
-        std::clamp<domain::Scalar>(pos[0], 0, config_.field_size[0] - 1),
-        std::clamp<domain::Scalar>(pos[1], 0, config_.field_size[1] - 1),
+    // the flowers nearest to the player, ordered by the distance and the index. A probed move takes them and their
+    // enemy distances from the shared ones unless a flower has been respawned.
+    const auto flowers_to_handle = static_cast<int>(std::min(config_.number_of_enemies, config_.number_of_flowers));
+    const auto shared = probing_ && step_.flowers.empty();
+    const auto flowers = flowers_buckets_.kNearest(flowers_to_handle);
+    const auto enemies_count = static_cast<int>(config_.number_of_enemies);
+    const auto sharedDistances = [&](const int flower) {
+        return probe_distances_.data() + static_cast<size_t>(probe_rows_[flower]) * enemies_count;
     };
+    // the enemies an earlier probe has chosen for the same leading flowers, and the record of this probe
+    const auto repeated = shared ? repeatedChoices(flowers) : std::span<const int>();
+    ProbeChoices* choices = nullptr;
+    if (shared) {
+        choices = &probe_choices_[probes_++];
+        choices->flowers.assign(flowers.begin(), flowers.end());
+        choices->enemies.clear();
+    }
+
+    if (config_.enemies_strategy == domain::EnemiesStrategy::Optimal) {
+        // the solve takes all the flowers, so it is repeated only for the same ones in the same order. The warm state
+        // it leaves is taken back with the move.
+        auto enemies = repeated;
+        if (repeated.size() != flowers.size()) {
+            enemies = assignment_.solve(
+                assignment_state_,
+                flowers,
+                enemies_count,
+                [&](const int flower, const int enemy) {
+                    if (shared) {
+                        return sharedDistances(flowers[flower])[enemy];
+                    }
+                    return internal::distanceBetween(
+                        state_.flowers.positions[flowers[flower]], state_.enemies.position[enemy]);
+                });
+        }
+        if (choices) {
+            choices->enemies.assign(enemies.begin(), enemies.end());
+        }
+        for (size_t i = 0; i < flowers.size(); ++i) {
+            forwardEnemy(enemies[i], state_.flowers.positions[flowers[i]]);
+        }
+    } else {
+        std::ranges::fill(enemy_assigned_, false);
+        for (size_t i = 0; i < flowers.size(); ++i) {
+            const auto& flower_position = state_.flowers.positions[flowers[i]];
+            // the unassigned enemies have not moved, so the choice is repeated until a flower is respawned
+            const auto unchanged = step_.flowers.empty();
+            const auto enemy = unchanged && i < repeated.size()
+                ? repeated[i]
+                : enemies_index_.nearest(
+                      flower_position[0], flower_position[1], [this](const int e) { return enemy_assigned_[e] != 0; });
+            if (choices && unchanged) {
+                choices->enemies.push_back(enemy);
+            }
+            enemy_assigned_[enemy] = true;
+            forwardEnemy(enemy, flower_position);
+        }
+    }
+
+    state_.game_status = domain::GameStatus::PlayerTurn;
 }
 
-void Engine::forwardEnemy(const int enemy_index, const domain::Position& flower)
+template<class Scalar, class Map>
+void BasicEngine<Scalar, Map>::forwardEnemy(const int enemy_index, const Position& flower)
 {
     auto& enemy = state_.enemies.position[enemy_index];
-    domain::Vector vec = flower - enemy;
-    vec[0] = std::clamp<domain::Scalar>(vec[0], -1, 1);
-    vec[1] = std::clamp<domain::Scalar>(vec[1], -1, 1);
-    domain::Position new_pos = enemy + vec;
-    auto place = objects_map_.getType(new_pos);
-    if (place == ObjectType::Player || place == ObjectType::Enemy) {
-        new_pos = clampPosition(enemy + rotate45(vec));
-        place = objects_map_.getType(new_pos);
-        if (place == ObjectType::Player || place == ObjectType::Enemy) {
-            new_pos = clampPosition(enemy + rotateNeg45(vec));
-            place = objects_map_.getType(new_pos);
-        }
-        if (place == ObjectType::Player || place == ObjectType::Enemy) {
-            return; // can't move enemy
-        }
+    const auto step = internal::findEnemyStep<Scalar>(objects_map_, config_.field_size, enemy, flower);
+    if (!step) {
+        return; // can't move enemy
     }
-    objects_map_.setType(enemy, ObjectType::Empty);
-    objects_map_.setType(new_pos, ObjectType::Enemy);
-    enemy = new_pos;
-    if (place == ObjectType::Flower) {
-        const auto flower_index = getFlowerIndex(new_pos);
+    const auto flower_index = objects_map_.getId(step->position);
+    hash_ ^= internal::zobrist::cellKey(cellNumber(enemy), ObjectType::Enemy) ^
+        internal::zobrist::cellKey(cellNumber(step->position), ObjectType::Enemy);
+    setCell(enemy, ObjectType::Empty);
+    setCell(step->position, ObjectType::Enemy, enemy_index);
+    step_.enemies.push_back({static_cast<uint32_t>(enemy_index), enemy, step->position});
+    enemy = step->position;
+    enemies_index_.move(enemy_index, enemy[0], enemy[1]);
+    if (step->place == ObjectType::Flower) {
         placeFlower(flower_index);
     }
 }
 
+template class BasicEngine<int8_t>;
+template class BasicEngine<int16_t>;
+template class BasicEngine<int32_t>;
+template class BasicEngine<int8_t, internal::BitboardObjectMap>;
+template class BasicEngine<int16_t, internal::PackedObjectMap>;
+template class BasicEngine<int16_t, internal::SparseObjectMap>;
+template class BasicEngine<int16_t, internal::MortonObjectMap>;
+template class BasicEngine<int8_t, internal::PaddedObjectMap>;
+
 } // namespace logic
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace logic::internal {
+
+// Min-cost assignment of the rows to distinct columns, rows <= columns, by the shortest augmenting paths
+// (Jonker-Volgenant). Zero-cost dummy rows make the problem square, they take the columns left free.
+// The column prices and the pairs of the previous solve are the warm start of the next one: the pairs whose rows are
+// still there and still cheapest at the prices are kept, only the other rows are augmented.
+// The solver holds the scratch buffers only, the warm state is kept by the caller, one per game.
+class AssignmentSolver {
+public:
+    // What the next solve of a game starts from, empty for a solve from scratch
+    struct WarmState {
+        std::vector<int> prices;
+        // the key of the row the column is assigned to, -1 for a dummy row
+        std::vector<int> column_keys;
+
+        void clear()
+        {
+            prices.clear();
+            column_keys.clear();
+        }
+    };
+
+    // Returns the column of every row. cost(row, column) is a non-negative int. The row keys are distinct
+    // non-negative ints naming the rows across the solves of the game, the flower indexes, so the pairs of the
+    // previous solve are found whatever the rows order is. The span is valid until the next solve call.
+    template<class Cost>
+    std::span<const int> solve(WarmState& warm, std::span<const int> row_keys, int columns, Cost cost);
+
+private:
+    // rows x columns costs of the current solve and the costs of the dummy rows
+    std::vector<int> costs_;
+    std::vector<int> zero_costs_;
+    int rows_ = 0;
+    // the real rows and then the dummy ones
+    std::vector<int> row_column_;
+    std::vector<int> column_row_;
+    // the row of a key of the current solve, -1 elsewhere
+    std::vector<int> key_rows_;
+    // augment scratch buffers
+    std::vector<int> keys_;
+    std::vector<int> shifts_;
+    std::vector<int> predecessors_;
+    std::vector<int> scanned_;
+    std::vector<int> scanned_distances_;
+
+    void run(WarmState& warm, std::span<const int> row_keys, int columns);
+    // Drops the pairs that are not the cheapest ones of their rows at the warm prices
+    void keepTightPairs(const WarmState& warm, int columns);
+    [[nodiscard]] const int* rowCosts(int row, int columns) const;
+    void unassign(int row);
+    // Assigns the free row along the shortest augmenting path and updates the prices
+    void augment(WarmState& warm, int row, int columns);
+};
+
+template<class Cost>
+std::span<const int> AssignmentSolver::solve(
+    WarmState& warm, const std::span<const int> row_keys, const int columns, Cost cost)
+{
+    const auto rows = static_cast<int>(row_keys.size());
+    costs_.resize(static_cast<size_t>(rows) * columns);
+    for (int row = 0; row < rows; ++row) {
+        auto* costs = costs_.data() + static_cast<size_t>(row) * columns;
+        for (int column = 0; column < columns; ++column) {
+            costs[column] = cost(row, column);
+        }
+    }
+    run(warm, row_keys, columns);
+    return {row_column_.data(), static_cast<size_t>(rows)};
+}
+
+} // namespace logic::internal
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "domain/config.h"
+#include "domain/state.h"
+#include "logic/assignment.h"
+#include "logic/distance_buckets.h"
+#include "logic/engine.h"
+#include "logic/random.h"
+
+#include <span>
+#include <vector>
+
+namespace logic {
+
+// N independent games kept in structure-of-arrays form and stepped in one call.
+// Game i plays exactly as logic::BasicEngine<Scalar>(config, seed + i): it is started with that seed and started over
+// with startGame() as soon as it ends.
+template<class Scalar>
+class BasicBatchEngine {
+public:
+    using Position = domain::BasicPosition<Scalar>;
+    using Vector = domain::BasicVector<Scalar>;
+    using State = domain::BasicState<Scalar>;
+
+    BasicBatchEngine(const domain::Config& config, size_t games, uint64_t seed);
+
+    // Makes moves[i] in the game i. getStatus() reports PlayerWon or PlayerLost for the games that have ended
+    // on this step, these games are already restarted.
+    void step(const Vector* moves);
+
+    [[nodiscard]] size_t size() const { return games_; }
+    [[nodiscard]] std::span<const domain::GameStatus> getStatus() const { return status_; }
+    // Scores the player got on the last step
+    [[nodiscard]] std::span<const unsigned> getRewards() const { return rewards_; }
+    [[nodiscard]] std::span<const unsigned> getScores() const { return scores_; }
+    [[nodiscard]] std::span<const unsigned> getSteps() const { return steps_; }
+    [[nodiscard]] std::span<const Scalar> getPlayerX() const { return player_x_; }
+    [[nodiscard]] std::span<const Scalar> getPlayerY() const { return player_y_; }
+    // Coordinates of the game's enemies and flowers, config.number_of_enemies/number_of_flowers per game
+    [[nodiscard]] std::span<const Scalar> getEnemiesX(size_t game) const;
+    [[nodiscard]] std::span<const Scalar> getEnemiesY(size_t game) const;
+    [[nodiscard]] std::span<const Scalar> getFlowersX(size_t game) const;
+    [[nodiscard]] std::span<const Scalar> getFlowersY(size_t game) const;
+    [[nodiscard]] std::span<const unsigned> getFlowersScores(size_t game) const;
+    // Copy of the game in the logic::Engine form
+    [[nodiscard]] State getState(size_t game) const;
+
+private:
+    const domain::Config& config_;
+    const size_t games_;
+    const size_t enemies_;
+    const size_t flowers_;
+    internal::ScoreGenerator score_generator_;
+    std::vector<internal::Random> rngs_;
+    std::vector<internal::ObjectMap> objects_maps_;
+    // the enemies matching solver of the optimal strategy is shared by the games, each game keeps its warm state
+    internal::AssignmentSolver assignment_;
+    // one per game with the optimal enemies strategy, empty otherwise
+    std::vector<internal::AssignmentSolver::WarmState> assignment_states_;
+
+    std::vector<Scalar> player_x_;
+    std::vector<Scalar> player_y_;
+    std::vector<unsigned> scores_;
+    std::vector<unsigned> steps_;
+    std::vector<Scalar> enemies_x_;
+    std::vector<Scalar> enemies_y_;
+    std::vector<Scalar> flowers_x_;
+    std::vector<Scalar> flowers_y_;
+    std::vector<unsigned> flowers_scores_;
+    // the flowers of a game bucketed by the distance to its player, kept up to date as the player and the flowers move
+    std::vector<internal::DistanceBuckets> flowers_buckets_;
+
+    std::vector<domain::GameStatus> status_;
+    std::vector<unsigned> rewards_;
+
+    // step scratch buffers
+    std::vector<Scalar> target_x_;
+    std::vector<Scalar> target_y_;
+    std::vector<uint8_t> target_inside_;
+    std::vector<int> flowers_order_;
+    std::vector<uint8_t> enemy_assigned_;
+
+    void startGame(size_t game);
+    void movePlayer(size_t game);
+    void movePlayerTo(size_t game, const Position& new_pos);
+    void placeFlower(size_t game, size_t index);
+    // The count flowers nearest to the player into flowers_order_, ordered by the distance and the index
+    void selectThreatenedFlowers(size_t game, int count);
+    void moveEnemies(size_t game);
+    void forwardEnemy(size_t game, size_t enemy_index, const Position& flower);
+};
+
+extern template class BasicBatchEngine<int8_t>;
+extern template class BasicBatchEngine<int16_t>;
+extern template class BasicBatchEngine<int32_t>;
+
+using BatchEngine = BasicBatchEngine<domain::Scalar>;
+
+} // namespace logic
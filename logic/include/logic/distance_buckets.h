@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace logic::internal {
+
+// The entities with ids 0..count-1 bucketed by the Chebyshev distance to a center that moves a cell at a time.
+// The lines through the center split the field into 4 cones, in a cone the distance is the x or the y offset,
+// so a bucket is a column of the right or the left cone or a row of the upper or the lower one, all of its entities
+// are at the same distance. A step of the center keeps every column and row where it is, only the entities near
+// the diagonals through the center may change the cone. These are found by the lists of the diagonals, so a step
+// costs O(count / side) instead of O(count) and kNearest costs O(k) plus the skipped empty distances.
+// The buckets and the diagonals are intrusive doubly linked lists as in SpatialIndex, so a copy allocates nothing.
+class DistanceBuckets {
+public:
+    DistanceBuckets(int width, int height, int count);
+
+    // Takes all the entities out and puts the center at (x, y)
+    void clear(int x, int y);
+    void insert(int id, int x, int y);
+    void move(int id, int x, int y);
+    // Moves the center, a unit step re-buckets the entities near the diagonals only, a longer one re-buckets all
+    void moveCenter(int x, int y);
+
+    // The k entities nearest to the center, ties are broken by the id. With a margin the entities up to margin
+    // farther than the k-th one follow in the same order, the k nearest to a center moved by margin / 2 are among
+    // them. The span is valid until the next call.
+    std::span<const int> kNearest(int k, int margin = 0);
+
+private:
+    static constexpr int npos = -1;
+    enum Cone : int8_t { Right, Left, Up, Down };
+
+    struct Lists {
+        std::vector<int> heads;
+        std::vector<int> next;
+        std::vector<int> prev;
+
+        Lists(int lists, int count) : heads(lists, npos), next(count, npos), prev(count, npos) {}
+        void link(int id, int list);
+        // Links the id after the lower ids of the list
+        void linkSorted(int id, int list);
+        void unlink(int id, int list);
+    };
+
+    int width_, height_;
+    int center_x_ = 0, center_y_ = 0;
+    std::vector<int> x_;
+    std::vector<int> y_;
+    // npos if the entity is out
+    std::vector<int> bucket_;
+    // the ids of a bucket are in the ascending order, so the buckets of a distance are merged rather than sorted.
+    // The buckets of a cone follow the ones of the previous cone, side_ each.
+    int side_;
+    Lists buckets_;
+    // a bit per bucket, set if the bucket is not empty
+    std::vector<uint64_t> occupied_;
+    // the diagonals x - y + height - 1 and x + y
+    Lists falling_;
+    Lists rising_;
+    // kNearest scratch buffer
+    std::vector<int> result_;
+
+    [[nodiscard]] int bucketOf(int x, int y) const;
+    void link(int id, int bucket);
+    void unlink(int id);
+    void rebucket(int id);
+    // The first non-empty bucket of the cone from the key on, away from the center, or npos
+    [[nodiscard]] int nearestBucket(Cone cone, int key) const;
+    [[nodiscard]] int fallingOf(const int id) const { return x_[id] - y_[id] + height_ - 1; }
+    [[nodiscard]] int risingOf(const int id) const { return x_[id] + y_[id]; }
+};
+
+} // namespace logic::internal
@@ -2,62 +2,248 @@
 
 #include "domain/config.h"
 #include "domain/state.h"
+#include "domain/step_delta.h"
+#include "logic/assignment.h"
+#include "logic/distance_buckets.h"
+#include "logic/object_map.h"
+#include "logic/random.h"
+#include "logic/spatial_index.h"
 
-#include <random>
+#include <array>
+#include <deque>
+#include <span>
+#include <vector>
 
 namespace logic {
 
 namespace internal {
-    class ObjectMap {
-    public:
-        enum class ObjectType : uint8_t { Empty, Player, Enemy, Flower };
-
-        ObjectMap(int width, int height);
-
-        void clean();
-        domain::Position placeObject(ObjectType object);
-        [[nodiscard]] ObjectType getType(domain::Position pos) const;
-        void setType(domain::Position pos, ObjectType type);
-
-    private:
-        const int width_, height_;
-        std::mt19937 rng_;
-        std::vector<ObjectType> objects_bitmap_;
-    };
-
     class ScoreGenerator {
     public:
         ScoreGenerator(unsigned min, unsigned max);
-        unsigned generate();
+        unsigned generate(Random& rng) const;
 
     private:
-        std::mt19937 rng_;
-        std::uniform_int_distribution<unsigned> score_distribution_;
+        unsigned min_;
+        unsigned range_;
     };
 } // namespace internal
 
-class Engine {
+// The player move directions counterclockwise from (1, 0), bit i of a legal moves mask is the direction i
+inline constexpr std::array<std::array<int, 2>, 8> move_directions{{
+    {1, 0},
+    {1, 1},
+    {0, 1},
+    {-1, 1},
+    {-1, 0},
+    {-1, -1},
+    {0, -1},
+    {1, -1},
+}};
+
+// Scalar is the coordinates type, it limits the field size to std::numeric_limits<Scalar>::max().
+// Map is the cells storage, all the maps give the same games for the same seed.
+template<class Scalar, class Map = internal::ObjectMap>
+class BasicEngine {
 public:
-    explicit Engine(const domain::Config &config);
+    using Position = domain::BasicPosition<Scalar>;
+    using Vector = domain::BasicVector<Scalar>;
+    using State = domain::BasicState<Scalar>;
+    using StepDelta = domain::BasicStepDelta<Scalar>;
+
+    // What a player move would do
+    struct MoveOutcome {
+        // the player can step to the cell, the other members are meaningful only for the legal moves
+        bool legal;
+        bool eats_flower;
+        // the score of the eaten flower
+        unsigned score_delta;
+        // with the enemy responses, the changes move() would make, the enemy moves and the respawns included
+        StepDelta response;
+    };
+
+    explicit BasicEngine(const domain::Config &config);
+    // Throws std::invalid_argument if the field does not fit the coordinates type
+    BasicEngine(const domain::Config &config, uint64_t seed);
     void startGame();
-    void move(const domain::Vector& direction);
-    [[nodiscard]] const domain::State &getState() const { return state_; }
+    // Reseeds the generator, so the same seed and moves replay the same game
+    void startGame(uint64_t seed);
+    // Returns the changes the move made, valid until the next move
+    const StepDelta& move(const Vector& direction);
+    [[nodiscard]] const State &getState() const { return state_; }
+    // Bit i is set if the player can step in move_directions[i]: the cell is in the field and is empty or a flower
+    [[nodiscard]] uint8_t legalMoves() const;
+    // The outcomes of the moves in move_directions, valid until the next call. The enemy responses are the moves
+    // made and taken back, so the engine is left as it was and the generator state too. The moves share the threatened
+    // flowers candidates and their distances to the enemies. Without the responses the outcomes take the neighbour
+    // probes only.
+    const std::array<MoveOutcome, 8>& evaluateMoves(bool enemy_responses = false);
+    // Zobrist hash of the position: the cells of the player, the enemies and the flowers, the flower scores and the
+    // player steps and scores. It is kept up to date by the moves and is the same for every map and run.
+    // The positions differing only by the object indexes or the generator state have the same hash.
+    [[nodiscard]] uint64_t getHash() const { return hash_; }
+
+    // An independent engine in the same position sharing the config, it plays the game on as this engine would.
+    // The journal is not copied and is off in the fork.
+    [[nodiscard]] BasicEngine fork() const;
+    // Puts the engine in the position of the other one, made from the same config object, and clears the journal.
+    // The storage is reused, so restoring an engine of the same config allocates nothing.
+    // Throws std::invalid_argument if the engines are made from different configs.
+    void restoreFrom(const BasicEngine& other);
+
+    // Journals up to the plies last moves for undo, 0 (the default) turns the journal off.
+    // The journal is cleared here and on every game start.
+    void setUndoDepth(size_t plies);
+    // Takes the last move back without replaying the game, returns false if the journal has no move to take back.
+    // The next move plays as if the taken back one had never been made.
+    bool undo();
+    // Makes the move taken back by undo again, returns false if there is none. A move drops the moves to redo.
+    bool redo();
 
 private:
+    using ObjectType = internal::ObjectMap::ObjectType;
+
+    // The content of a cell before a change, slot is the free cells list slot of a cell that was empty
+    struct CellChange {
+        Scalar x;
+        Scalar y;
+        ObjectType type;
+        int id;
+        int slot;
+    };
+    // The journal entry of a move: what is needed to take it back and to make it again
+    struct Ply {
+        Vector direction;
+        internal::Random::StateType rng;
+        domain::SoundEffects sound_effects;
+        uint64_t hash;
+        StepDelta step;
+        // in the order of the changes
+        std::vector<CellChange> cells;
+        // only with the optimal strategy
+        internal::AssignmentSolver::WarmState assignment;
+    };
+
     const domain::Config &config_;
-    internal::ObjectMap objects_map_;
+    internal::Random rng_;
+    Map objects_map_;
     internal::ScoreGenerator score_generator_;
-    domain::State state_;
+    State state_;
+    // the flowers bucketed by the distance to the player, the threatened ones are the first buckets
+    internal::DistanceBuckets flowers_buckets_;
+    internal::SpatialIndex enemies_index_;
+    // enemies matching solver of the optimal strategy, warm-started with the previous turn prices and pairs
+    internal::AssignmentSolver assignment_;
+    internal::AssignmentSolver::WarmState assignment_state_;
+    // moveEnemies scratch buffer, sized once to keep the turn allocation-free
+    std::vector<uint8_t> enemy_assigned_;
+    StepDelta step_;
+    uint64_t hash_ = 0;
+    // ring buffer of the undo journal, the plies [plies_begin_, plies_cursor_) can be taken back
+    // and [plies_cursor_, plies_end_) made again, the ply n is at n % size
+    std::vector<Ply> plies_;
+    uint64_t plies_begin_ = 0;
+    uint64_t plies_cursor_ = 0;
+    uint64_t plies_end_ = 0;
+    // the ply of the move being made if the journal is on
+    Ply* recording_ = nullptr;
+    // evaluateMoves buffers
+    std::array<MoveOutcome, 8> outcomes_;
+    Ply probe_;
+    StepDelta last_step_;
+    // the flowers the probed moves may threaten and their distances to the enemies, a row of the enemies per flower.
+    // The probes take them while no flower has been respawned.
+    std::vector<int> probe_flowers_;
+    std::vector<int> probe_distances_;
+    // the row of a flower, set for the probe flowers only
+    std::vector<int> probe_rows_;
+    std::vector<int64_t> probe_keys_;
+    std::vector<int> probe_order_;
+    // the flowers order of a probed move and the enemies it has chosen for them before a flower was respawned,
+    // a later probe with the same leading flowers repeats the choices
+    struct ProbeChoices {
+        std::vector<int> flowers;
+        std::vector<int> enemies;
+    };
+    std::array<ProbeChoices, 8> probe_choices_;
+    int probes_ = 0;
+    bool probing_ = false;
 
+    const StepDelta& play(const Vector& direction);
+    // Makes the move journaling it into the ply if there is one
+    void makeMove(const Vector& direction, Ply* ply);
+    void takeBack(const Ply& ply);
+    // Changes the map cell, the journal gets its previous content
+    void setCell(const Position& pos, ObjectType type, int id = 0);
+    // The cell number the hash keys take, x * height + y whatever the map layout is
+    [[nodiscard]] int64_t cellNumber(const Position& pos) const;
     void placeFlower(ptrdiff_t index);
+    // Shares the threatened flowers candidates and their enemy distances among the moves evaluateMoves probes
+    void prepareProbes();
+    // The count probe flowers nearest to the player, ordered by the distance and the index
+    std::span<const int> selectProbeFlowers(int count);
+    // The enemies of the earlier probe that shares the most leading flowers, the greedy choices for them
+    [[nodiscard]] std::span<const int> repeatedChoices(std::span<const int> flowers) const;
     void moveEnemies();
-    void movePlayer(const domain::Vector& direction);
-    void movePlayerTo(const domain::Position& new_pos);
-    void eatFlowerByPlayer();
-    [[nodiscard]] ptrdiff_t getFlowerIndex(const domain::Position &pos) const;
+    void movePlayer(const Vector& direction);
+    void movePlayerTo(const Position& new_pos);
+    void eatFlowerByPlayer(ptrdiff_t index);
     void updateStatusAfterPlayerHasMoved();
-    void forwardEnemy(int enemy_index, const domain::Position& flower);
-    [[nodiscard]] domain::Position clampPosition(const domain::Position& pos) const;
+    void forwardEnemy(int enemy_index, const Position& flower);
 };
 
+extern template class BasicEngine<int8_t>;
+extern template class BasicEngine<int16_t>;
+extern template class BasicEngine<int32_t>;
+extern template class BasicEngine<int8_t, internal::BitboardObjectMap>;
+extern template class BasicEngine<int16_t, internal::PackedObjectMap>;
+extern template class BasicEngine<int16_t, internal::SparseObjectMap>;
+extern template class BasicEngine<int16_t, internal::MortonObjectMap>;
+extern template class BasicEngine<int8_t, internal::PaddedObjectMap>;
+
+// Reused forks for a tree search. fork() restores an idle engine from the source instead of making a new one,
+// so once the pool has grown to the search width the forks allocate nothing.
+template<class Engine>
+class EnginePool {
+public:
+    // The engines to fork must be made from this config object
+    explicit EnginePool(const domain::Config& config)
+        : config_(config)
+    {
+    }
+
+    // Returns an engine in the position of the source, it is the caller's until released
+    Engine& fork(const Engine& source)
+    {
+        if (idle_.empty()) {
+            idle_.push_back(&engines_.emplace_back(config_, 0));
+        }
+        Engine& engine = *idle_.back();
+        idle_.pop_back();
+        engine.restoreFrom(source);
+        return engine;
+    }
+    void release(Engine& engine) { idle_.push_back(&engine); }
+    // Number of the engines made so far
+    [[nodiscard]] size_t size() const { return engines_.size(); }
+
+private:
+    const domain::Config& config_;
+    // the deque keeps the engines in place as it grows
+    std::deque<Engine> engines_;
+    std::vector<Engine*> idle_;
+};
+
+using Engine = BasicEngine<domain::Scalar>;
+// Engine for the fields up to 64x64
+using BitboardEngine = BasicEngine<domain::Scalar, internal::BitboardObjectMap>;
+// Engine for the fields above 127 cells with a quarter byte per cell for the cell types
+using PackedEngine = BasicEngine<int16_t, internal::PackedObjectMap>;
+// Engine for the giant fields with few objects, the map memory and the restart cost do not depend on the field area
+using SparseEngine = BasicEngine<int16_t, internal::SparseObjectMap>;
+// Engine for the large fields with the map cells in the Z-order
+using MortonEngine = BasicEngine<int16_t, internal::MortonObjectMap>;
+// Engine with the Wall border around the field, the moves need no bounds checks. A move is a step in one of the
+// 8 directions.
+using PaddedEngine = BasicEngine<domain::Scalar, internal::PaddedObjectMap>;
+
 } // namespace logic
@@ -0,0 +1,452 @@
+#pragma once
+
+#include "logic/random.h"
+
+#include <Eigen/Core>
+
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <vector>
+
+namespace logic::internal {
+
+// Open addressing table of non-negative int keys to int values, linear probing with backward shift deletion.
+// The size is a power of two at most half full.
+class IntHashMap {
+public:
+    IntHashMap();
+
+    void clear();
+    // The value of the key or nullptr
+    [[nodiscard]] const int* find(int key) const;
+    void set(int key, int value);
+    void erase(int key);
+    [[nodiscard]] int size() const { return size_; }
+
+private:
+    static constexpr int no_key = -1;
+
+    std::vector<int> keys_;
+    std::vector<int> values_;
+    int size_ = 0;
+    int shift_;
+
+    [[nodiscard]] uint32_t home(int key) const;
+    // The slot of the key or the empty slot it would take
+    [[nodiscard]] uint32_t slot(int key) const;
+    void grow();
+};
+
+// Dense list of the empty cell indexes and the back-map cell index -> slot in the list.
+// Every map keeps its empty cells here, so the objects placement for a seed does not depend on the map.
+class FreeCells {
+public:
+    explicit FreeCells(int cells);
+
+    // All the cells are empty
+    void reset();
+    void occupy(int cell);
+    void release(int cell);
+    // Slot of the empty cell in the list
+    [[nodiscard]] int slotOf(int cell) const { return slots_[cell]; }
+    // Inverse of occupy(cell) that took the cell from the slot, the list is the same as before the occupy
+    void restore(int cell, int slot);
+    // Uniformly random empty cell, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] int pick(Random& rng) const;
+    [[nodiscard]] int size() const { return static_cast<int>(cells_.size()); }
+
+private:
+    std::vector<int> cells_;
+    std::vector<int> slots_;
+};
+
+// FreeCells that store only the entries differing from the initial identity list, so the memory and the reset
+// cost follow the number of the occupied cells instead of the field area. The picks are the same as of FreeCells.
+class SparseFreeCells {
+public:
+    explicit SparseFreeCells(int cells);
+
+    // All the cells are empty
+    void reset();
+    void occupy(int cell);
+    void release(int cell);
+    // Slot of the empty cell in the list
+    [[nodiscard]] int slotOf(int cell) const;
+    // Inverse of occupy(cell) that took the cell from the slot, the list is the same as before the occupy
+    void restore(int cell, int slot);
+    // Uniformly random empty cell, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] int pick(Random& rng) const;
+    [[nodiscard]] int size() const { return size_; }
+
+private:
+    int cells_;
+    int size_;
+    // slot -> cell and cell -> slot, a missing key maps to itself
+    IntHashMap slot_cells_;
+    IntHashMap cell_slots_;
+
+    [[nodiscard]] int cellAt(int slot) const;
+    static void setEntry(IntHashMap& map, int key, int value);
+};
+
+class ObjectMap {
+public:
+    // Wall is the border of PaddedObjectMap, the other maps never hold it
+    enum class ObjectType : uint8_t { Empty, Player, Enemy, Flower, Wall };
+
+    ObjectMap(int width, int height);
+
+    void clean();
+    // Places the object on a random empty cell and returns the cell coordinates,
+    // throws std::runtime_error if there is no empty cell
+    Eigen::Vector2i placeObject(ObjectType object, int id, Random& rng);
+    [[nodiscard]] ObjectType getType(int x, int y) const;
+    // Index of the enemy or the flower in the state, meaningless for an empty cell
+    [[nodiscard]] int getId(int x, int y) const;
+    void setType(int x, int y, ObjectType type, int id = 0);
+    // The cell placeObject would take, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] Eigen::Vector2i pickEmpty(Random& rng) const;
+    // Slot of the empty cell in the free cells list
+    [[nodiscard]] int freeSlot(int x, int y) const;
+    // Inverse of setType that filled the empty cell taken from the slot of the free cells list
+    void restoreEmpty(int x, int y, int slot);
+
+    template<class Position>
+    [[nodiscard]] ObjectType getType(const Position& pos) const
+    {
+        return getType(pos[0], pos[1]);
+    }
+    template<class Position>
+    [[nodiscard]] int getId(const Position& pos) const
+    {
+        return getId(pos[0], pos[1]);
+    }
+    template<class Position>
+    void setType(const Position& pos, const ObjectType type, const int id = 0)
+    {
+        setType(pos[0], pos[1], type, id);
+    }
+    [[nodiscard]] int freeCellsCount() const { return free_cells_.size(); }
+
+private:
+    int width_, height_;
+    std::vector<ObjectType> objects_bitmap_;
+    std::vector<int> objects_ids_;
+    FreeCells free_cells_;
+
+    void setCellType(int cell, ObjectType type, int id);
+};
+
+// ObjectMap for the fields up to 64x64 with one bit plane per object type, the cells are numbered as in ObjectMap.
+// A cell type is three bit tests and the eight neighbours of a cell are read with a few word operations.
+class BitboardObjectMap {
+public:
+    using ObjectType = ObjectMap::ObjectType;
+    static constexpr int max_side = 64;
+
+    // Throws std::invalid_argument if a side exceeds max_side
+    BitboardObjectMap(int width, int height);
+
+    void clean();
+    // Places the object on a random empty cell and returns the cell coordinates,
+    // throws std::runtime_error if there is no empty cell
+    Eigen::Vector2i placeObject(ObjectType object, int id, Random& rng);
+    [[nodiscard]] ObjectType getType(int x, int y) const;
+    // Index of the enemy or the flower in the state, meaningless for an empty cell
+    [[nodiscard]] int getId(int x, int y) const { return ids_[x * height_ + y]; }
+    void setType(int x, int y, ObjectType type, int id = 0);
+    // The cell placeObject would take, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] Eigen::Vector2i pickEmpty(Random& rng) const;
+    // Slot of the empty cell in the free cells list
+    [[nodiscard]] int freeSlot(int x, int y) const;
+    // Inverse of setType that filled the empty cell taken from the slot of the free cells list
+    void restoreEmpty(int x, int y, int slot);
+    // Bit i is set if the neighbour in the direction i holds the type, the directions go counterclockwise
+    // (1, 0), (1, 1), (0, 1), (-1, 1), (-1, 0), (-1, -1), (0, -1), (1, -1). The type must not be Empty.
+    [[nodiscard]] uint8_t neighbours(int x, int y, ObjectType type) const;
+
+    template<class Position>
+    [[nodiscard]] ObjectType getType(const Position& pos) const
+    {
+        return getType(pos[0], pos[1]);
+    }
+    template<class Position>
+    [[nodiscard]] int getId(const Position& pos) const
+    {
+        return getId(pos[0], pos[1]);
+    }
+    template<class Position>
+    void setType(const Position& pos, const ObjectType type, const int id = 0)
+    {
+        setType(pos[0], pos[1], type, id);
+    }
+    [[nodiscard]] int freeCellsCount() const { return free_cells_.size(); }
+
+private:
+    // a zero guard word on both sides, so the neighbours of the first and the last cells are read without checks
+    static constexpr int guard_bits = 64;
+    using Plane = std::array<uint64_t, max_side * max_side / 64 + 2>;
+
+    int width_, height_;
+    // Player, Enemy and Flower planes
+    std::array<Plane, 3> planes_{};
+    // the ids are below the cells count, so 16 bits are enough
+    std::vector<uint16_t> ids_;
+    FreeCells free_cells_;
+
+    void setCellType(int cell, ObjectType type, int id);
+    // Bits of the cells first, first + 1, first + 2, first may be -1
+    [[nodiscard]] static unsigned readBits3(const Plane& plane, int first);
+};
+
+// ObjectMap for the huge fields: the types are packed 32 cells per word, only the occupied cells keep an id, in an open
+// addressing table, and the free cells list is the sparse one. The cells are numbered as in ObjectMap.
+class PackedObjectMap {
+public:
+    using ObjectType = ObjectMap::ObjectType;
+
+    PackedObjectMap(int width, int height);
+
+    void clean();
+    // Places the object on a random empty cell and returns the cell coordinates,
+    // throws std::runtime_error if there is no empty cell
+    Eigen::Vector2i placeObject(ObjectType object, int id, Random& rng);
+    [[nodiscard]] ObjectType getType(int x, int y) const
+    {
+        const auto cell = x * height_ + y;
+        return static_cast<ObjectType>((types_[cell >> 5] >> ((cell & 31) * 2)) & 3);
+    }
+    // Index of the enemy or the flower in the state, meaningless for an empty cell
+    [[nodiscard]] int getId(int x, int y) const;
+    void setType(int x, int y, ObjectType type, int id = 0);
+    // The cell placeObject would take, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] Eigen::Vector2i pickEmpty(Random& rng) const;
+    // Slot of the empty cell in the free cells list
+    [[nodiscard]] int freeSlot(int x, int y) const;
+    // Inverse of setType that filled the empty cell taken from the slot of the free cells list
+    void restoreEmpty(int x, int y, int slot);
+    // Number of the cells holding the type, counted a word at a time
+    [[nodiscard]] int64_t count(ObjectType type) const;
+
+    template<class Position>
+    [[nodiscard]] ObjectType getType(const Position& pos) const
+    {
+        return getType(pos[0], pos[1]);
+    }
+    template<class Position>
+    [[nodiscard]] int getId(const Position& pos) const
+    {
+        return getId(pos[0], pos[1]);
+    }
+    template<class Position>
+    void setType(const Position& pos, const ObjectType type, const int id = 0)
+    {
+        setType(pos[0], pos[1], type, id);
+    }
+    [[nodiscard]] int freeCellsCount() const { return free_cells_.size(); }
+
+private:
+    int width_, height_;
+    std::vector<uint64_t> types_;
+    // cell -> id of the occupied cells
+    IntHashMap ids_;
+    SparseFreeCells free_cells_;
+
+    void setCellType(int cell, ObjectType type, int id);
+};
+
+// ObjectMap with a one cell Wall border around the field: getType is valid one cell outside the field, so a step in any
+// of the 8 directions is a lookup without the bounds checks. The free cells are numbered as in ObjectMap.
+class PaddedObjectMap {
+public:
+    using ObjectType = ObjectMap::ObjectType;
+    static constexpr bool has_walls = true;
+
+    PaddedObjectMap(int width, int height);
+
+    void clean();
+    // Places the object on a random empty cell and returns the cell coordinates,
+    // throws std::runtime_error if there is no empty cell
+    Eigen::Vector2i placeObject(ObjectType object, int id, Random& rng);
+    // -1 <= x <= width and -1 <= y <= height
+    [[nodiscard]] ObjectType getType(int x, int y) const { return types_[index(x, y)]; }
+    // Index of the enemy or the flower in the state, meaningless for an empty cell
+    [[nodiscard]] int getId(int x, int y) const { return ids_[index(x, y)]; }
+    void setType(int x, int y, ObjectType type, int id = 0);
+    // The cell placeObject would take, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] Eigen::Vector2i pickEmpty(Random& rng) const;
+    // Slot of the empty cell in the free cells list
+    [[nodiscard]] int freeSlot(int x, int y) const;
+    // Inverse of setType that filled the empty cell taken from the slot of the free cells list
+    void restoreEmpty(int x, int y, int slot);
+    // The padded index of the cell and the type by it, a neighbour of an index is at index + directionOffset(i)
+    [[nodiscard]] int index(int x, int y) const { return (x + 1) * stride_ + y + 1; }
+    [[nodiscard]] ObjectType typeAt(int index) const { return types_[index]; }
+    [[nodiscard]] int idAt(int index) const { return ids_[index]; }
+    // Index offset of the direction i, the directions go as in BitboardObjectMap::neighbours
+    [[nodiscard]] int directionOffset(int direction) const { return direction_offsets_[direction]; }
+    // Index offset of the step (dx, dy), only a unit step stays within the border
+    [[nodiscard]] int directionOffset(int dx, int dy) const
+    {
+        assert(dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1);
+        return dx * stride_ + dy;
+    }
+
+    template<class Position>
+    [[nodiscard]] ObjectType getType(const Position& pos) const
+    {
+        return getType(pos[0], pos[1]);
+    }
+    template<class Position>
+    [[nodiscard]] int getId(const Position& pos) const
+    {
+        return getId(pos[0], pos[1]);
+    }
+    template<class Position>
+    void setType(const Position& pos, const ObjectType type, const int id = 0)
+    {
+        setType(pos[0], pos[1], type, id);
+    }
+    [[nodiscard]] int freeCellsCount() const { return free_cells_.size(); }
+
+private:
+    int width_, height_;
+    int stride_;
+    std::array<int, 8> direction_offsets_;
+    std::vector<ObjectType> types_;
+    std::vector<int> ids_;
+    FreeCells free_cells_;
+};
+
+// The maps with the Wall border, their getType takes the cells next to the field
+template<class Map>
+concept WalledMap = Map::has_walls;
+
+// The maps reading the 8 neighbours of a cell at once
+template<class Map>
+concept NeighbourMap = requires(const Map& map) {
+    { map.neighbours(0, 0, ObjectMap::ObjectType::Enemy) } -> std::same_as<uint8_t>;
+};
+
+// ObjectMap with the cells laid out in the Z-order (Morton) instead of the rows, so the 8-neighbourhood of a cell
+// mostly shares its cache lines. The coordinate bits are interleaved up to the shorter side, the rest of the bits of
+// the longer side go above them, so the padding is below 4x the area. The free cells are numbered as in ObjectMap.
+class MortonObjectMap {
+public:
+    using ObjectType = ObjectMap::ObjectType;
+
+    MortonObjectMap(int width, int height);
+
+    void clean();
+    // Places the object on a random empty cell and returns the cell coordinates,
+    // throws std::runtime_error if there is no empty cell
+    Eigen::Vector2i placeObject(ObjectType object, int id, Random& rng);
+    [[nodiscard]] ObjectType getType(int x, int y) const { return types_[index(x, y)]; }
+    // Index of the enemy or the flower in the state, meaningless for an empty cell
+    [[nodiscard]] int getId(int x, int y) const { return ids_[index(x, y)]; }
+    void setType(int x, int y, ObjectType type, int id = 0);
+    // The cell placeObject would take, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] Eigen::Vector2i pickEmpty(Random& rng) const;
+    // Slot of the empty cell in the free cells list
+    [[nodiscard]] int freeSlot(int x, int y) const;
+    // Inverse of setType that filled the empty cell taken from the slot of the free cells list
+    void restoreEmpty(int x, int y, int slot);
+
+    template<class Position>
+    [[nodiscard]] ObjectType getType(const Position& pos) const
+    {
+        return getType(pos[0], pos[1]);
+    }
+    template<class Position>
+    [[nodiscard]] int getId(const Position& pos) const
+    {
+        return getId(pos[0], pos[1]);
+    }
+    template<class Position>
+    void setType(const Position& pos, const ObjectType type, const int id = 0)
+    {
+        setType(pos[0], pos[1], type, id);
+    }
+    [[nodiscard]] int freeCellsCount() const { return free_cells_.size(); }
+
+private:
+    int width_, height_;
+    // the Morton index is x_bits_[x] | y_bits_[y]
+    std::vector<uint32_t> x_bits_;
+    std::vector<uint32_t> y_bits_;
+    std::vector<ObjectType> types_;
+    std::vector<int> ids_;
+    FreeCells free_cells_;
+
+    [[nodiscard]] size_t index(int x, int y) const { return x_bits_[x] | y_bits_[y]; }
+};
+
+// ObjectMap for the giant fields holding few objects: the cells live in 16x16 tiles allocated on the first
+// non-empty cell and found through a hash of the tile coordinates. A missing tile is empty. The memory and the clean
+// cost follow the number of the touched tiles and the placed objects, not the field area.
+// The cells are numbered as in ObjectMap.
+class SparseObjectMap {
+public:
+    using ObjectType = ObjectMap::ObjectType;
+
+    SparseObjectMap(int width, int height);
+
+    void clean();
+    // Places the object on a random empty cell and returns the cell coordinates,
+    // throws std::runtime_error if there is no empty cell
+    Eigen::Vector2i placeObject(ObjectType object, int id, Random& rng);
+    [[nodiscard]] ObjectType getType(int x, int y) const;
+    // Index of the enemy or the flower in the state, meaningless for an empty cell
+    [[nodiscard]] int getId(int x, int y) const;
+    void setType(int x, int y, ObjectType type, int id = 0);
+    // The cell placeObject would take, throws std::runtime_error if there is no empty cell
+    [[nodiscard]] Eigen::Vector2i pickEmpty(Random& rng) const;
+    // Slot of the empty cell in the free cells list
+    [[nodiscard]] int freeSlot(int x, int y) const;
+    // Inverse of setType that filled the empty cell taken from the slot of the free cells list
+    void restoreEmpty(int x, int y, int slot);
+    // Number of the allocated tiles
+    [[nodiscard]] int tilesCount() const { return used_tiles_; }
+
+    template<class Position>
+    [[nodiscard]] ObjectType getType(const Position& pos) const
+    {
+        return getType(pos[0], pos[1]);
+    }
+    template<class Position>
+    [[nodiscard]] int getId(const Position& pos) const
+    {
+        return getId(pos[0], pos[1]);
+    }
+    template<class Position>
+    void setType(const Position& pos, const ObjectType type, const int id = 0)
+    {
+        setType(pos[0], pos[1], type, id);
+    }
+    [[nodiscard]] int freeCellsCount() const { return free_cells_.size(); }
+
+private:
+    static constexpr int tile_bits = 4;
+    static constexpr int tile_side = 1 << tile_bits;
+
+    struct Tile {
+        std::array<ObjectType, tile_side * tile_side> types;
+        std::array<int, tile_side * tile_side> ids;
+    };
+
+    int width_, height_;
+    int tiles_height_;
+    // the pool keeps the tiles of the previous games, the first used_tiles_ are in use
+    std::vector<Tile> tiles_;
+    int used_tiles_ = 0;
+    // tile key -> index in the pool
+    IntHashMap tile_index_;
+    SparseFreeCells free_cells_;
+
+    [[nodiscard]] const Tile* findTile(int x, int y) const;
+    [[nodiscard]] static int tileOffset(int x, int y) { return ((x & (tile_side - 1)) << tile_bits) | (y & (tile_side - 1)); }
+};
+
+} // namespace logic::internal
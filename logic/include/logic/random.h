@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace logic::internal {
+
+// xoshiro128** generator (https://prng.di.unimi.it/) seeded through splitmix64.
+// 16 bytes of state and the same sequence on every platform for a given seed.
+class Random {
+public:
+    using result_type = uint32_t;
+    using StateType = std::array<uint32_t, 4>;
+
+    explicit Random(const uint64_t seed = 0) { reseed(seed); }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    void reseed(uint64_t seed)
+    {
+        for (size_t i = 0; i < state_.size(); i += 2) {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            z ^= z >> 31;
+            state_[i] = static_cast<uint32_t>(z);
+            state_[i + 1] = static_cast<uint32_t>(z >> 32);
+        }
+    }
+
+    result_type operator()()
+    {
+        const uint32_t result = rotl(state_[1] * 5, 7) * 9;
+        const uint32_t t = state_[1] << 9;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 11);
+        return result;
+    }
+
+    // Unbiased value in [0, bound), Lemire's multiply-shift rejection.
+    uint32_t uniform(const uint32_t bound)
+    {
+        uint64_t m = static_cast<uint64_t>((*this)()) * bound;
+        if (static_cast<uint32_t>(m) < bound) {
+            const uint32_t threshold = (0u - bound) % bound;
+            while (static_cast<uint32_t>(m) < threshold) {
+                m = static_cast<uint64_t>((*this)()) * bound;
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    [[nodiscard]] const StateType& getState() const { return state_; }
+    void setState(const StateType& state) { state_ = state; }
+
+private:
+    StateType state_;
+
+    static uint32_t rotl(const uint32_t x, const int k) { return (x << k) | (x >> (32 - k)); }
+};
+
+} // namespace logic::internal
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace logic::internal {
+
+// Uniform grid of square buckets over the entities with ids 0..count-1.
+// The buckets are intrusive doubly linked lists, so updates are O(1) and never allocate.
+class SpatialIndex {
+public:
+    SpatialIndex(int width, int height, int count);
+
+    void clear();
+    void insert(int id, int x, int y);
+    void move(int id, int x, int y);
+
+    // The k entities nearest to (x, y) by Chebyshev distance, ties are broken by the id.
+    // The span is valid until the next kNearest call.
+    std::span<const int> kNearest(int x, int y, int k);
+
+    // The nearest entity to (x, y) for which skip(id) is false, the lowest id among the equally distant ones.
+    // Returns -1 if all the entities are skipped.
+    template<class Skip>
+    [[nodiscard]] int nearest(int x, int y, Skip skip) const;
+
+private:
+    static constexpr int npos = -1;
+    static constexpr int single_bucket_count = 64;
+
+    int width_, height_;
+    int shift_;
+    int buckets_width_, buckets_height_;
+    std::vector<int> heads_;
+    std::vector<int> next_;
+    std::vector<int> prev_;
+    std::vector<int> bucket_;
+    std::vector<int> x_;
+    std::vector<int> y_;
+    // kNearest scratch buffers
+    std::vector<std::pair<int, int>> candidates_;
+    std::vector<int> result_;
+
+    [[nodiscard]] int bucketOf(const int x, const int y) const
+    {
+        return (x >> shift_) * buckets_height_ + (y >> shift_);
+    }
+    void link(int id, int bucket);
+    void unlink(int id);
+    [[nodiscard]] int distance(const int id, const int x, const int y) const
+    {
+        return std::max(std::abs(x_[id] - x), std::abs(y_[id] - y));
+    }
+    // Calls visit(id) for every entity in the buckets at Chebyshev distance ring from the bucket (bx, by).
+    // Returns false if the ring is entirely outside the grid.
+    template<class Visit>
+    bool visitRing(int bx, int by, int ring, Visit visit) const;
+};
+
+template<class Visit>
+bool SpatialIndex::visitRing(const int bx, const int by, const int ring, Visit visit) const
+{
+    const int x0 = bx - ring, x1 = bx + ring, y0 = by - ring, y1 = by + ring;
+    if (x0 < 0 && y0 < 0 && x1 >= buckets_width_ && y1 >= buckets_height_) {
+        return false;
+    }
+    const auto visitBucket = [&](const int x, const int y) {
+        if (x >= 0 && x < buckets_width_ && y >= 0 && y < buckets_height_) {
+            for (int id = heads_[x * buckets_height_ + y]; id != npos; id = next_[id]) {
+                visit(id);
+            }
+        }
+    };
+    if (ring == 0) {
+        if (heads_.size() == 1) {
+            // a single bucket holds every entity, a linear scan is cheaper than walking the list
+            for (int id = 0; id < std::ssize(bucket_); ++id) {
+                if (bucket_[id] != npos) {
+                    visit(id);
+                }
+            }
+        } else {
+            visitBucket(bx, by);
+        }
+        return true;
+    }
+    for (int x = x0; x <= x1; ++x) {
+        visitBucket(x, y0);
+        visitBucket(x, y1);
+    }
+    for (int y = y0 + 1; y < y1; ++y) {
+        visitBucket(x0, y);
+        visitBucket(x1, y);
+    }
+    return true;
+}
+
+template<class Skip>
+int SpatialIndex::nearest(const int x, const int y, Skip skip) const
+{
+    const int bx = x >> shift_, by = y >> shift_;
+    int best = npos;
+    int best_distance = std::numeric_limits<int>::max();
+    // after the ring r all the entities closer than r * bucket size + 1 are visited
+    for (int ring = 0;; ++ring) {
+        const bool inside = visitRing(bx, by, ring, [&](const int id) {
+            if (skip(id)) {
+                return;
+            }
+            const auto d = distance(id, x, y);
+            if (d < best_distance || (d == best_distance && id < best)) {
+                best_distance = d;
+                best = id;
+            }
+        });
+        if (!inside || best_distance <= (ring << shift_)) {
+            break;
+        }
+    }
+    return best;
+}
+
+} // namespace logic::internal
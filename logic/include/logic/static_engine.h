@@ -0,0 +1,155 @@
+#pragma once
+
+#include "domain/config.h"
+#include "domain/state.h"
+#include "domain/step_delta.h"
+#include "logic/assignment.h"
+#include "logic/engine.h"
+#include "logic/object_map.h"
+#include "logic/random.h"
+
+#include <array>
+#include <cstdint>
+
+namespace logic {
+
+// State of StaticEngine, the members are named as in domain::State and the counts are fixed
+template<int Enemies, int Flowers>
+struct StaticState final {
+    domain::Player player;
+    struct {
+        std::array<domain::Position, Enemies> position;
+    } enemies;
+    struct {
+        std::array<domain::Position, Flowers> positions;
+        std::array<unsigned, Flowers> scores;
+    } flowers;
+    domain::GameStatus game_status;
+    domain::SoundEffects sound_effects{domain::SoundEffects::None};
+};
+
+namespace internal {
+    // ObjectMap with the fixed field size and the free cells list kept inline
+    template<int Width, int Height>
+    class StaticObjectMap {
+    public:
+        using ObjectType = ObjectMap::ObjectType;
+
+        void clean()
+        {
+            types_.fill(ObjectType::Empty);
+            for (int cell = 0; cell < cells; ++cell) {
+                free_cells_[cell] = static_cast<uint16_t>(cell);
+                slots_[cell] = static_cast<uint16_t>(cell);
+            }
+            free_count_ = cells;
+        }
+        // Places the object on a random empty cell and returns the cell coordinates, the same cell as ObjectMap
+        domain::Position placeObject(const ObjectType object, const int id, Random& rng)
+        {
+            const int cell = free_cells_[rng.uniform(static_cast<uint32_t>(free_count_))];
+            setCellType(cell, object, id);
+            return {static_cast<domain::Scalar>(cell / Height), static_cast<domain::Scalar>(cell % Height)};
+        }
+        template<class Position>
+        [[nodiscard]] ObjectType getType(const Position& pos) const
+        {
+            return types_[pos[0] * Height + pos[1]];
+        }
+        template<class Position>
+        [[nodiscard]] int getId(const Position& pos) const
+        {
+            return ids_[pos[0] * Height + pos[1]];
+        }
+        template<class Position>
+        void setType(const Position& pos, const ObjectType type, const int id = 0)
+        {
+            setCellType(pos[0] * Height + pos[1], type, id);
+        }
+
+    private:
+        static constexpr int cells = Width * Height;
+
+        std::array<ObjectType, cells> types_;
+        std::array<uint16_t, cells> ids_;
+        // the swap-remove list of FreeCells
+        std::array<uint16_t, cells> free_cells_;
+        std::array<uint16_t, cells> slots_;
+        int free_count_ = 0;
+
+        void setCellType(const int cell, const ObjectType type, const int id)
+        {
+            ids_[cell] = static_cast<uint16_t>(id);
+            const auto old_type = types_[cell];
+            types_[cell] = type;
+            if (old_type == ObjectType::Empty && type != ObjectType::Empty) {
+                const auto slot = slots_[cell];
+                const auto last = free_cells_[--free_count_];
+                free_cells_[slot] = last;
+                slots_[last] = slot;
+            } else if (old_type != ObjectType::Empty && type == ObjectType::Empty) {
+                slots_[cell] = static_cast<uint16_t>(free_count_);
+                free_cells_[free_count_++] = static_cast<uint16_t>(cell);
+            }
+        }
+    };
+} // namespace internal
+
+// Engine for one fixed field size and objects count: the state and the map are inline arrays and the loops over
+// the objects have constant bounds. It plays exactly as Engine(config, seed) for a config with these sizes.
+// The other config values are read at run time.
+// The members are defined in static_engine.cpp, which instantiates the configurations in use.
+template<int Width, int Height, int Enemies, int Flowers>
+class StaticEngine {
+public:
+    static_assert(Width <= 127 && Height <= 127, "The coordinates are int8_t");
+    static_assert(1 + Enemies + Flowers <= Width * Height, "The objects do not fit the field");
+
+    using Position = domain::Position;
+    using Vector = domain::Vector;
+    using State = StaticState<Enemies, Flowers>;
+    using StepDelta = domain::StepDelta;
+
+    explicit StaticEngine(const domain::Config& config);
+    // Throws std::invalid_argument if the config sizes differ from the template ones
+    StaticEngine(const domain::Config& config, uint64_t seed);
+    // The config sizes are the template ones
+    [[nodiscard]] static bool matches(const domain::Config& config)
+    {
+        return config.field_size[0] == Width && config.field_size[1] == Height && config.number_of_enemies == Enemies &&
+            config.number_of_flowers == Flowers;
+    }
+    void startGame();
+    // Reseeds the generator, so the same seed and moves replay the same game
+    void startGame(uint64_t seed);
+    // Returns the changes the move made, valid until the next move
+    const StepDelta& move(const Vector& direction);
+    [[nodiscard]] const State& getState() const { return state_; }
+
+private:
+    static constexpr int flowers_to_handle = Enemies < Flowers ? Enemies : Flowers;
+
+    const domain::Config& config_;
+    internal::Random rng_;
+    internal::StaticObjectMap<Width, Height> objects_map_;
+    internal::ScoreGenerator score_generator_;
+    State state_;
+    // enemies matching solver of the optimal strategy, it allocates only if the strategy is used
+    internal::AssignmentSolver assignment_;
+    internal::AssignmentSolver::WarmState assignment_state_;
+    StepDelta step_;
+
+    void placeFlower(int index);
+    void moveEnemies();
+    void movePlayer(const Vector& direction);
+    void movePlayerTo(const Position& new_pos);
+    void updateStatusAfterPlayerHasMoved();
+    void forwardEnemy(int enemy_index, const Position& flower);
+};
+
+extern template class StaticEngine<18, 18, 5, 15>;
+
+// The default config field and objects
+using DefaultStaticEngine = StaticEngine<18, 18, 5, 15>;
+
+} // namespace logic
@@ -0,0 +1,708 @@
+#include "logic/object_map.h"
+// msvc 2022 does not implement mdspan[x,y]
+#define MDSPAN_USE_BRACKET_OPERATOR 0
+#include <experimental/mdspan>
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace logic::internal {
+
+using std::experimental::mdspan;
+
+IntHashMap::IntHashMap()
+    : keys_(16, no_key)
+    , values_(16)
+    , shift_(32 - 4)
+{
+}
+
+void IntHashMap::clear()
+{
+    std::ranges::fill(keys_, no_key);
+    size_ = 0;
+}
+
+const int* IntHashMap::find(const int key) const
+{
+    const auto index = slot(key);
+    return keys_[index] == key ? &values_[index] : nullptr;
+}
+
+void IntHashMap::set(const int key, const int value)
+{
+    if (2 * (size_ + 1) > std::ssize(keys_)) {
+        grow();
+    }
+    const auto index = slot(key);
+    if (keys_[index] == no_key) {
+        keys_[index] = key;
+        size_++;
+    }
+    values_[index] = value;
+}
+
+void IntHashMap::erase(const int key)
+{
+    auto hole = slot(key);
+    if (keys_[hole] != key) {
+        return;
+    }
+    size_--;
+    // the following entries of the cluster move into the hole if it is on their probe path
+    const auto mask = static_cast<uint32_t>(keys_.size() - 1);
+    for (auto next = (hole + 1) & mask; keys_[next] != no_key; next = (next + 1) & mask) {
+        if (((next - home(keys_[next])) & mask) >= ((next - hole) & mask)) {
+            keys_[hole] = keys_[next];
+            values_[hole] = values_[next];
+            hole = next;
+        }
+    }
+    keys_[hole] = no_key;
+}
+
+uint32_t IntHashMap::home(const int key) const
+{
+    // Fibonacci hashing, the top bits of the product select the slot
+    return (static_cast<uint32_t>(key) * 0x9e3779b1u) >> shift_;
+}
+
+uint32_t IntHashMap::slot(const int key) const
+{
+    const auto mask = static_cast<uint32_t>(keys_.size() - 1);
+    auto index = home(key);
+    while (keys_[index] != no_key && keys_[index] != key) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void IntHashMap::grow()
+{
+    const auto keys = std::exchange(keys_, std::vector<int>(keys_.size() * 2, no_key));
+    const auto values = std::exchange(values_, std::vector<int>(values_.size() * 2));
+    shift_--;
+    size_ = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] != no_key) {
+            set(keys[i], values[i]);
+        }
+    }
+}
+
+FreeCells::FreeCells(const int cells)
+    : cells_(cells)
+    , slots_(cells)
+{
+    reset();
+}
+
+void FreeCells::reset()
+{
+    cells_.resize(slots_.size());
+    std::iota(cells_.begin(), cells_.end(), 0);
+    std::iota(slots_.begin(), slots_.end(), 0);
+}
+
+void FreeCells::occupy(const int cell)
+{
+    // swap-remove the cell from the list
+    const auto slot = slots_[cell];
+    const auto last = cells_.back();
+    cells_[slot] = last;
+    slots_[last] = slot;
+    cells_.pop_back();
+}
+
+void FreeCells::release(const int cell)
+{
+    slots_[cell] = static_cast<int>(cells_.size());
+    cells_.push_back(cell);
+}
+
+void FreeCells::restore(const int cell, const int slot)
+{
+    // the cell that took the slot goes back to the end
+    if (slot < size()) {
+        const auto moved = cells_[slot];
+        slots_[moved] = size();
+        cells_.push_back(moved);
+        cells_[slot] = cell;
+    } else {
+        cells_.push_back(cell);
+    }
+    slots_[cell] = slot;
+}
+
+int FreeCells::pick(Random& rng) const
+{
+    if (cells_.empty()) {
+        throw std::runtime_error("No empty cell to place an object");
+    }
+    return cells_[rng.uniform(static_cast<uint32_t>(cells_.size()))];
+}
+
+SparseFreeCells::SparseFreeCells(const int cells)
+    : cells_(cells)
+    , size_(cells)
+{
+}
+
+void SparseFreeCells::reset()
+{
+    slot_cells_.clear();
+    cell_slots_.clear();
+    size_ = cells_;
+}
+
+void SparseFreeCells::occupy(const int cell)
+{
+    // the swap-remove of FreeCells, the entries of the removed cell and of the dropped last slot are forgotten
+    const auto slot = slotOf(cell);
+    const auto last_slot = size_ - 1;
+    const auto last = cellAt(last_slot);
+    setEntry(slot_cells_, slot, last);
+    setEntry(cell_slots_, last, slot);
+    slot_cells_.erase(last_slot);
+    cell_slots_.erase(cell);
+    size_--;
+}
+
+void SparseFreeCells::release(const int cell)
+{
+    setEntry(slot_cells_, size_, cell);
+    setEntry(cell_slots_, cell, size_);
+    size_++;
+}
+
+void SparseFreeCells::restore(const int cell, const int slot)
+{
+    // the cell that took the slot goes back to the end
+    if (slot < size_) {
+        const auto moved = cellAt(slot);
+        setEntry(slot_cells_, size_, moved);
+        setEntry(cell_slots_, moved, size_);
+    }
+    setEntry(slot_cells_, slot, cell);
+    setEntry(cell_slots_, cell, slot);
+    size_++;
+}
+
+int SparseFreeCells::pick(Random& rng) const
+{
+    if (size_ == 0) {
+        throw std::runtime_error("No empty cell to place an object");
+    }
+    return cellAt(static_cast<int>(rng.uniform(static_cast<uint32_t>(size_))));
+}
+
+int SparseFreeCells::cellAt(const int slot) const
+{
+    const auto* cell = slot_cells_.find(slot);
+    return cell ? *cell : slot;
+}
+
+int SparseFreeCells::slotOf(const int cell) const
+{
+    const auto* slot = cell_slots_.find(cell);
+    return slot ? *slot : cell;
+}
+
+void SparseFreeCells::setEntry(IntHashMap& map, const int key, const int value)
+{
+    if (key == value) {
+        map.erase(key);
+    } else {
+        map.set(key, value);
+    }
+}
+
+ObjectMap::ObjectMap(const int width, const int height)
+    : width_(width)
+    , height_(height)
+    , objects_bitmap_(width_ * height_, ObjectType::Empty)
+    , objects_ids_(width_ * height_)
+    , free_cells_(width_ * height_)
+{
+}
+
+void ObjectMap::clean()
+{
+    std::ranges::fill(objects_bitmap_, ObjectType::Empty);
+    free_cells_.reset();
+}
+
+Eigen::Vector2i ObjectMap::placeObject(const ObjectType object, const int id, Random& rng)
+{
+    const auto cell = free_cells_.pick(rng);
+    setCellType(cell, object, id);
+    return {cell / height_, cell % height_};
+}
+
+ObjectMap::ObjectType ObjectMap::getType(const int x, const int y) const
+{
+    const auto objects = mdspan(objects_bitmap_.data(), width_, height_);
+    return objects(x, y);
+}
+
+int ObjectMap::getId(const int x, const int y) const
+{
+    const auto ids = mdspan(objects_ids_.data(), width_, height_);
+    return ids(x, y);
+}
+
+void ObjectMap::setType(const int x, const int y, const ObjectType type, const int id)
+{
+    setCellType(x * height_ + y, type, id);
+}
+
+Eigen::Vector2i ObjectMap::pickEmpty(Random& rng) const
+{
+    const auto cell = free_cells_.pick(rng);
+    return {cell / height_, cell % height_};
+}
+
+int ObjectMap::freeSlot(const int x, const int y) const
+{
+    return free_cells_.slotOf(x * height_ + y);
+}
+
+void ObjectMap::restoreEmpty(const int x, const int y, const int slot)
+{
+    objects_bitmap_[x * height_ + y] = ObjectType::Empty;
+    free_cells_.restore(x * height_ + y, slot);
+}
+
+void ObjectMap::setCellType(const int cell, const ObjectType type, const int id)
+{
+    objects_ids_[cell] = id;
+    const auto old_type = std::exchange(objects_bitmap_[cell], type);
+    if (old_type == ObjectType::Empty && type != ObjectType::Empty) {
+        free_cells_.occupy(cell);
+    } else if (old_type != ObjectType::Empty && type == ObjectType::Empty) {
+        free_cells_.release(cell);
+    }
+}
+
+BitboardObjectMap::BitboardObjectMap(const int width, const int height)
+    : width_(width)
+    , height_(height)
+    , ids_(width_ * height_)
+    , free_cells_(width_ * height_)
+{
+    if (width_ > max_side || height_ > max_side) {
+        throw std::invalid_argument("The field is too large for the bitboard map");
+    }
+}
+
+void BitboardObjectMap::clean()
+{
+    planes_ = {};
+    free_cells_.reset();
+}
+
+Eigen::Vector2i BitboardObjectMap::placeObject(const ObjectType object, const int id, Random& rng)
+{
+    const auto cell = free_cells_.pick(rng);
+    setCellType(cell, object, id);
+    return {cell / height_, cell % height_};
+}
+
+BitboardObjectMap::ObjectType BitboardObjectMap::getType(const int x, const int y) const
+{
+    const auto bit = x * height_ + y + guard_bits;
+    const auto word = bit >> 6;
+    const auto shift = bit & 63;
+    // at most one plane has the bit, Player = 1, Enemy = 2, Flower = 3
+    const auto player = (planes_[0][word] >> shift) & 1;
+    const auto enemy = (planes_[1][word] >> shift) & 1;
+    const auto flower = (planes_[2][word] >> shift) & 1;
+    return static_cast<ObjectType>(player | (enemy << 1) | (flower * 3));
+}
+
+void BitboardObjectMap::setType(const int x, const int y, const ObjectType type, const int id)
+{
+    setCellType(x * height_ + y, type, id);
+}
+
+Eigen::Vector2i BitboardObjectMap::pickEmpty(Random& rng) const
+{
+    const auto cell = free_cells_.pick(rng);
+    return {cell / height_, cell % height_};
+}
+
+int BitboardObjectMap::freeSlot(const int x, const int y) const
+{
+    return free_cells_.slotOf(x * height_ + y);
+}
+
+void BitboardObjectMap::restoreEmpty(const int x, const int y, const int slot)
+{
+    const auto bit = x * height_ + y + guard_bits;
+    planes_[static_cast<int>(getType(x, y)) - 1][bit >> 6] &= ~(uint64_t{1} << (bit & 63));
+    free_cells_.restore(x * height_ + y, slot);
+}
+
+void BitboardObjectMap::setCellType(const int cell, const ObjectType type, const int id)
+{
+    ids_[cell] = static_cast<uint16_t>(id);
+    const auto bit = cell + guard_bits;
+    const auto mask = uint64_t{1} << (bit & 63);
+    bool was_empty = true;
+    for (auto& plane: planes_) {
+        was_empty &= (plane[bit >> 6] & mask) == 0;
+        plane[bit >> 6] &= ~mask;
+    }
+    if (type != ObjectType::Empty) {
+        planes_[static_cast<int>(type) - 1][bit >> 6] |= mask;
+    }
+    if (was_empty && type != ObjectType::Empty) {
+        free_cells_.occupy(cell);
+    } else if (!was_empty && type == ObjectType::Empty) {
+        free_cells_.release(cell);
+    }
+}
+
+unsigned BitboardObjectMap::readBits3(const Plane& plane, const int first)
+{
+    const auto bit = first + guard_bits;
+    const auto word = bit >> 6;
+    const auto shift = bit & 63;
+    auto bits = plane[word] >> shift;
+    if (shift > 61) {
+        bits |= plane[word + 1] << (64 - shift);
+    }
+    return static_cast<unsigned>(bits & 7);
+}
+
+uint8_t BitboardObjectMap::neighbours(const int x, const int y, const ObjectType type) const
+{
+    const auto& plane = planes_[static_cast<int>(type) - 1];
+    // the bits of the cells below and above a column edge belong to the neighbour columns
+    const unsigned edges = (y == 0 ? 1u : 0u) | (y == height_ - 1 ? 4u : 0u);
+    const auto column = [&](const int column_x) {
+        return column_x < 0 || column_x >= width_ ? 0u : readBits3(plane, column_x * height_ + y - 1) & ~edges;
+    };
+    // column bits 0, 1, 2 are the cells y - 1, y, y + 1
+    const auto right = column(x + 1);
+    const auto middle = column(x);
+    const auto left = column(x - 1);
+    return static_cast<uint8_t>(
+        ((right >> 1) & 1) | ((right >> 2) << 1) | ((middle >> 2) << 2) | ((left >> 2) << 3) | (((left >> 1) & 1) << 4) |
+        ((left & 1) << 5) | ((middle & 1) << 6) | ((right & 1) << 7));
+}
+
+PackedObjectMap::PackedObjectMap(const int width, const int height)
+    : width_(width)
+    , height_(height)
+    , types_((width_ * height_ + 31) / 32)
+    , free_cells_(width_ * height_)
+{
+}
+
+void PackedObjectMap::clean()
+{
+    std::ranges::fill(types_, 0);
+    ids_.clear();
+    free_cells_.reset();
+}
+
+Eigen::Vector2i PackedObjectMap::placeObject(const ObjectType object, const int id, Random& rng)
+{
+    const auto cell = free_cells_.pick(rng);
+    setCellType(cell, object, id);
+    return {cell / height_, cell % height_};
+}
+
+int PackedObjectMap::getId(const int x, const int y) const
+{
+    const auto* id = ids_.find(x * height_ + y);
+    return id ? *id : 0;
+}
+
+void PackedObjectMap::setType(const int x, const int y, const ObjectType type, const int id)
+{
+    setCellType(x * height_ + y, type, id);
+}
+
+Eigen::Vector2i PackedObjectMap::pickEmpty(Random& rng) const
+{
+    const auto cell = free_cells_.pick(rng);
+    return {cell / height_, cell % height_};
+}
+
+int PackedObjectMap::freeSlot(const int x, const int y) const
+{
+    return free_cells_.slotOf(x * height_ + y);
+}
+
+void PackedObjectMap::restoreEmpty(const int x, const int y, const int slot)
+{
+    const auto cell = x * height_ + y;
+    types_[cell >> 5] &= ~(uint64_t{3} << ((cell & 31) * 2));
+    ids_.erase(cell);
+    free_cells_.restore(x * height_ + y, slot);
+}
+
+int64_t PackedObjectMap::count(const ObjectType type) const
+{
+    constexpr uint64_t low_bits = 0x5555555555555555ull;
+    const auto pattern = low_bits * static_cast<uint64_t>(type);
+    int64_t result = 0;
+    for (const auto word: types_) {
+        // a two-bit field of the difference is zero where the cell holds the type
+        const auto difference = word ^ pattern;
+        result += std::popcount(~(difference | (difference >> 1)) & low_bits);
+    }
+    if (type == ObjectType::Empty) {
+        // the fields after the last cell are empty too
+        result -= static_cast<int64_t>(types_.size()) * 32 - static_cast<int64_t>(width_) * height_;
+    }
+    return result;
+}
+
+void PackedObjectMap::setCellType(const int cell, const ObjectType type, const int id)
+{
+    auto& word = types_[cell >> 5];
+    const auto shift = (cell & 31) * 2;
+    const auto old_type = static_cast<ObjectType>((word >> shift) & 3);
+    word = (word & ~(uint64_t{3} << shift)) | (uint64_t{static_cast<uint8_t>(type)} << shift);
+    if (type != ObjectType::Empty) {
+        ids_.set(cell, id);
+        if (old_type == ObjectType::Empty) {
+            free_cells_.occupy(cell);
+        }
+    } else if (old_type != ObjectType::Empty) {
+        ids_.erase(cell);
+        free_cells_.release(cell);
+    }
+}
+
+PaddedObjectMap::PaddedObjectMap(const int width, const int height)
+    : width_(width)
+    , height_(height)
+    , stride_(height_ + 2)
+    , direction_offsets_{stride_, stride_ + 1, 1, 1 - stride_, -stride_, -stride_ - 1, -1, stride_ - 1}
+    , types_(static_cast<size_t>(width_ + 2) * stride_)
+    , ids_(types_.size())
+    , free_cells_(width_ * height_)
+{
+    clean();
+}
+
+void PaddedObjectMap::clean()
+{
+    std::ranges::fill(types_, ObjectType::Wall);
+    for (int x = 0; x < width_; ++x) {
+        std::fill_n(types_.begin() + index(x, 0), height_, ObjectType::Empty);
+    }
+    free_cells_.reset();
+}
+
+Eigen::Vector2i PaddedObjectMap::placeObject(const ObjectType object, const int id, Random& rng)
+{
+    const auto cell = free_cells_.pick(rng);
+    const Eigen::Vector2i pos{cell / height_, cell % height_};
+    setType(pos[0], pos[1], object, id);
+    return pos;
+}
+
+void PaddedObjectMap::setType(const int x, const int y, const ObjectType type, const int id)
+{
+    const auto i = index(x, y);
+    ids_[i] = id;
+    const auto old_type = std::exchange(types_[i], type);
+    if (old_type == ObjectType::Empty && type != ObjectType::Empty) {
+        free_cells_.occupy(x * height_ + y);
+    } else if (old_type != ObjectType::Empty && type == ObjectType::Empty) {
+        free_cells_.release(x * height_ + y);
+    }
+}
+
+Eigen::Vector2i PaddedObjectMap::pickEmpty(Random& rng) const
+{
+    const auto cell = free_cells_.pick(rng);
+    return {cell / height_, cell % height_};
+}
+
+int PaddedObjectMap::freeSlot(const int x, const int y) const
+{
+    return free_cells_.slotOf(x * height_ + y);
+}
+
+void PaddedObjectMap::restoreEmpty(const int x, const int y, const int slot)
+{
+    types_[index(x, y)] = ObjectType::Empty;
+    free_cells_.restore(x * height_ + y, slot);
+}
+
+namespace {
+    // Moves the bits of the value below 2^interleaved to every second position starting from the first one,
+    // the bits above go after them
+    uint32_t spreadBits(const uint32_t value, const int interleaved, const int first)
+    {
+        uint32_t result = value >> interleaved << (2 * interleaved);
+        for (int bit = 0; bit < interleaved; ++bit) {
+            result |= ((value >> bit) & 1) << (2 * bit + first);
+        }
+        return result;
+    }
+} // namespace
+
+MortonObjectMap::MortonObjectMap(const int width, const int height)
+    : width_(width)
+    , height_(height)
+    , x_bits_(width_)
+    , y_bits_(height_)
+    , free_cells_(width_ * height_)
+{
+    const auto width_bits = std::bit_width(static_cast<uint32_t>(width_ - 1));
+    const auto height_bits = std::bit_width(static_cast<uint32_t>(height_ - 1));
+    // only the longer side has the bits above the interleaved ones
+    const auto interleaved = std::min(width_bits, height_bits);
+    for (int x = 0; x < width_; ++x) {
+        x_bits_[x] = spreadBits(static_cast<uint32_t>(x), interleaved, 1);
+    }
+    for (int y = 0; y < height_; ++y) {
+        y_bits_[y] = spreadBits(static_cast<uint32_t>(y), interleaved, 0);
+    }
+    types_.assign(size_t{1} << (width_bits + height_bits), ObjectType::Empty);
+    ids_.resize(types_.size());
+}
+
+void MortonObjectMap::clean()
+{
+    std::ranges::fill(types_, ObjectType::Empty);
+    free_cells_.reset();
+}
+
+Eigen::Vector2i MortonObjectMap::placeObject(const ObjectType object, const int id, Random& rng)
+{
+    const auto cell = free_cells_.pick(rng);
+    const Eigen::Vector2i pos{cell / height_, cell % height_};
+    setType(pos[0], pos[1], object, id);
+    return pos;
+}
+
+void MortonObjectMap::setType(const int x, const int y, const ObjectType type, const int id)
+{
+    const auto i = index(x, y);
+    ids_[i] = id;
+    const auto old_type = std::exchange(types_[i], type);
+    if (old_type == ObjectType::Empty && type != ObjectType::Empty) {
+        free_cells_.occupy(x * height_ + y);
+    } else if (old_type != ObjectType::Empty && type == ObjectType::Empty) {
+        free_cells_.release(x * height_ + y);
+    }
+}
+
+Eigen::Vector2i MortonObjectMap::pickEmpty(Random& rng) const
+{
+    const auto cell = free_cells_.pick(rng);
+    return {cell / height_, cell % height_};
+}
+
+int MortonObjectMap::freeSlot(const int x, const int y) const
+{
+    return free_cells_.slotOf(x * height_ + y);
+}
+
+void MortonObjectMap::restoreEmpty(const int x, const int y, const int slot)
+{
+    types_[index(x, y)] = ObjectType::Empty;
+    free_cells_.restore(x * height_ + y, slot);
+}
+
+SparseObjectMap::SparseObjectMap(const int width, const int height)
+    : width_(width)
+    , height_(height)
+    , tiles_height_((height_ + tile_side - 1) >> tile_bits)
+    , free_cells_(width_ * height_)
+{
+}
+
+void SparseObjectMap::clean()
+{
+    for (int i = 0; i < used_tiles_; ++i) {
+        tiles_[i].types.fill(ObjectType::Empty);
+    }
+    used_tiles_ = 0;
+    tile_index_.clear();
+    free_cells_.reset();
+}
+
+Eigen::Vector2i SparseObjectMap::placeObject(const ObjectType object, const int id, Random& rng)
+{
+    const auto cell = free_cells_.pick(rng);
+    const Eigen::Vector2i pos{cell / height_, cell % height_};
+    setType(pos[0], pos[1], object, id);
+    return pos;
+}
+
+const SparseObjectMap::Tile* SparseObjectMap::findTile(const int x, const int y) const
+{
+    const auto* index = tile_index_.find((x >> tile_bits) * tiles_height_ + (y >> tile_bits));
+    return index ? &tiles_[*index] : nullptr;
+}
+
+SparseObjectMap::ObjectType SparseObjectMap::getType(const int x, const int y) const
+{
+    const auto* tile = findTile(x, y);
+    return tile ? tile->types[tileOffset(x, y)] : ObjectType::Empty;
+}
+
+int SparseObjectMap::getId(const int x, const int y) const
+{
+    const auto* tile = findTile(x, y);
+    return tile ? tile->ids[tileOffset(x, y)] : 0;
+}
+
+void SparseObjectMap::setType(const int x, const int y, const ObjectType type, const int id)
+{
+    const auto key = (x >> tile_bits) * tiles_height_ + (y >> tile_bits);
+    int index;
+    if (const auto* found = tile_index_.find(key)) {
+        index = *found;
+    } else if (type == ObjectType::Empty) {
+        return;
+    } else {
+        if (used_tiles_ == std::ssize(tiles_)) {
+            tiles_.emplace_back().types.fill(ObjectType::Empty);
+        }
+        index = used_tiles_++;
+        tile_index_.set(key, index);
+    }
+    auto& tile = tiles_[index];
+    const auto offset = tileOffset(x, y);
+    tile.ids[offset] = id;
+    const auto old_type = std::exchange(tile.types[offset], type);
+    const auto cell = x * height_ + y;
+    if (old_type == ObjectType::Empty && type != ObjectType::Empty) {
+        free_cells_.occupy(cell);
+    } else if (old_type != ObjectType::Empty && type == ObjectType::Empty) {
+        free_cells_.release(cell);
+    }
+}
+
+Eigen::Vector2i SparseObjectMap::pickEmpty(Random& rng) const
+{
+    const auto cell = free_cells_.pick(rng);
+    return {cell / height_, cell % height_};
+}
+
+int SparseObjectMap::freeSlot(const int x, const int y) const
+{
+    return free_cells_.slotOf(x * height_ + y);
+}
+
+void SparseObjectMap::restoreEmpty(const int x, const int y, const int slot)
+{
+    // the tile is there, the cell is not empty
+    tiles_[*tile_index_.find((x >> tile_bits) * tiles_height_ + (y >> tile_bits))].types[tileOffset(x, y)] =
+        ObjectType::Empty;
+    free_cells_.restore(x * height_ + y, slot);
+}
+
+} // namespace logic::internal
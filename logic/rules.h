@@ -0,0 +1,108 @@
+#pragma once
+#include "logic/engine.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace logic::internal {
+
+template<class Scalar>
+int distanceBetween(const domain::BasicPosition<Scalar>& p1, const domain::BasicPosition<Scalar>& p2)
+{
+    return (p1.template cast<int>() - p2.template cast<int>()).array().abs().maxCoeff();
+}
+
+template<class Scalar>
+domain::BasicVector<Scalar> rotate45(const domain::BasicVector<Scalar>& vec)
+{
+    const auto xNew = std::clamp<Scalar>(vec[0] - vec[1], -1, 1);
+    const auto yNew = std::clamp<Scalar>(vec[0] + vec[1], -1, 1);
+    return domain::BasicVector<Scalar>{xNew, yNew};
+}
+
+template<class Scalar>
+domain::BasicVector<Scalar> rotateNeg45(const domain::BasicVector<Scalar>& vec)
+{
+    const auto xNew = std::clamp<Scalar>(vec[0] + vec[1], -1, 1);
+    const auto yNew = std::clamp<Scalar>(-vec[0] + vec[1], -1, 1);
+    return domain::BasicVector<Scalar>{xNew, yNew};
+}
+
+template<class Scalar>
+domain::BasicPosition<Scalar> clampPosition(const domain::BasicPosition<Scalar>& pos, const domain::Size& field_size)
+{
+    return {
+        std::clamp<Scalar>(pos[0], 0, static_cast<Scalar>(field_size[0] - 1)),
+        std::clamp<Scalar>(pos[1], 0, static_cast<Scalar>(field_size[1] - 1)),
+    };
+}
+
+inline bool isBlocked(const ObjectMap::ObjectType place)
+{
+    return place == ObjectMap::ObjectType::Player || place == ObjectMap::ObjectType::Enemy;
+}
+
+// The cells the player can step to
+inline bool isFreeForPlayer(const ObjectMap::ObjectType place)
+{
+    return place == ObjectMap::ObjectType::Empty || place == ObjectMap::ObjectType::Flower;
+}
+
+template<class Scalar>
+struct EnemyStep {
+    domain::BasicPosition<Scalar> position;
+    ObjectMap::ObjectType place;
+};
+
+// The unit step of the enemy and the cell type there, a step aside is moved back into the field if it leaves it.
+// The Wall border is probed by the index, the clamping is needed only if the step hits the wall.
+template<class Scalar, class Map>
+EnemyStep<Scalar> probeEnemyStep(
+    const Map& objects_map,
+    const domain::Size& field_size,
+    const domain::BasicPosition<Scalar>& enemy,
+    const domain::BasicVector<Scalar>& step)
+{
+    if constexpr (WalledMap<Map>) {
+        const auto place =
+            objects_map.typeAt(objects_map.index(enemy[0], enemy[1]) + objects_map.directionOffset(step[0], step[1]));
+        if (place != ObjectMap::ObjectType::Wall) {
+            return {enemy + step, place};
+        }
+    }
+    const auto pos = clampPosition<Scalar>(enemy + step, field_size);
+    return {pos, objects_map.getType(pos)};
+}
+
+// The cell the enemy steps to on the way to the flower: straight or 45 degrees aside if the way is blocked
+// by the player or another enemy. Returns nullopt if the enemy can't move.
+template<class Scalar, class Map>
+std::optional<EnemyStep<Scalar>> findEnemyStep(
+    const Map& objects_map,
+    const domain::Size& field_size,
+    const domain::BasicPosition<Scalar>& enemy,
+    const domain::BasicPosition<Scalar>& flower)
+{
+    domain::BasicVector<Scalar> vec = flower - enemy;
+    vec[0] = std::clamp<Scalar>(vec[0], -1, 1);
+    vec[1] = std::clamp<Scalar>(vec[1], -1, 1);
+    // the straight step heads to the flower, so it never leaves the field
+    EnemyStep<Scalar> step;
+    if constexpr (WalledMap<Map>) {
+        step = probeEnemyStep<Scalar>(objects_map, field_size, enemy, vec);
+    } else {
+        step = {enemy + vec, objects_map.getType(enemy + vec)};
+    }
+    if (isBlocked(step.place)) {
+        step = probeEnemyStep<Scalar>(objects_map, field_size, enemy, rotate45<Scalar>(vec));
+        if (isBlocked(step.place)) {
+            step = probeEnemyStep<Scalar>(objects_map, field_size, enemy, rotateNeg45<Scalar>(vec));
+        }
+        if (isBlocked(step.place)) {
+            return std::nullopt;
+        }
+    }
+    return step;
+}
+
+} // namespace logic::internal
@@ -0,0 +1,113 @@
+#include "logic/spatial_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace logic::internal {
+
+SpatialIndex::SpatialIndex(const int width, const int height, const int count)
+    : width_(width)
+    , height_(height)
+    , next_(count, npos)
+    , prev_(count, npos)
+    , bucket_(count, npos)
+    , x_(count)
+    , y_(count)
+{
+    // a few entities are faster to scan in one bucket, otherwise about eight entities per bucket
+    const auto bucket_size = count <= single_bucket_count ? std::max(width_, height_)
+                                                          : std::sqrt(8.0 * width_ * height_ / count);
+    shift_ = std::bit_width(static_cast<unsigned>(std::ceil(std::max(bucket_size, 1.0))) - 1);
+    buckets_width_ = ((width_ - 1) >> shift_) + 1;
+    buckets_height_ = ((height_ - 1) >> shift_) + 1;
+    heads_.assign(buckets_width_ * buckets_height_, npos);
+    candidates_.reserve(count);
+    result_.reserve(count);
+}
+
+void SpatialIndex::clear()
+{
+    std::ranges::fill(heads_, npos);
+    std::ranges::fill(bucket_, npos);
+}
+
+void SpatialIndex::insert(const int id, const int x, const int y)
+{
+    x_[id] = x;
+    y_[id] = y;
+    link(id, bucketOf(x, y));
+}
+
+void SpatialIndex::move(const int id, const int x, const int y)
+{
+    x_[id] = x;
+    y_[id] = y;
+    if (const auto bucket = bucketOf(x, y); bucket != bucket_[id]) {
+        unlink(id);
+        link(id, bucket);
+    }
+}
+
+void SpatialIndex::link(const int id, const int bucket)
+{
+    bucket_[id] = bucket;
+    prev_[id] = npos;
+    next_[id] = heads_[bucket];
+    if (next_[id] != npos) {
+        prev_[next_[id]] = id;
+    }
+    heads_[bucket] = id;
+}
+
+void SpatialIndex::unlink(const int id)
+{
+    if (bucket_[id] == npos) {
+        return;
+    }
+    if (prev_[id] != npos) {
+        next_[prev_[id]] = next_[id];
+    } else {
+        heads_[bucket_[id]] = next_[id];
+    }
+    if (next_[id] != npos) {
+        prev_[next_[id]] = prev_[id];
+    }
+    bucket_[id] = npos;
+}
+
+std::span<const int> SpatialIndex::kNearest(const int x, const int y, const int k)
+{
+    candidates_.clear();
+    result_.clear();
+    if (k <= 0) {
+        return result_;
+    }
+    const int bx = x >> shift_, by = y >> shift_;
+    // distance of the k-th nearest candidate, it only decreases as more candidates are found
+    int kth_distance = std::numeric_limits<int>::max();
+    for (int ring = 0;; ++ring) {
+        const bool inside =
+            visitRing(bx, by, ring, [&](const int id) { candidates_.emplace_back(distance(id, x, y), id); });
+        if (!inside) {
+            break;
+        }
+        if (kth_distance == std::numeric_limits<int>::max() && std::ssize(candidates_) >= k) {
+            std::ranges::nth_element(candidates_, candidates_.begin() + (k - 1));
+            kth_distance = candidates_[k - 1].first;
+        }
+        // after the ring r all the entities closer than r * bucket size + 1 are visited
+        if (kth_distance <= (ring << shift_)) {
+            break;
+        }
+    }
+    const auto n = std::min<size_t>(k, candidates_.size());
+    std::ranges::partial_sort(candidates_, candidates_.begin() + n);
+    for (size_t i = 0; i < n; ++i) {
+        result_.push_back(candidates_[i].second);
+    }
+    return result_;
+}
+
+} // namespace logic::internal
@@ -0,0 +1,222 @@
+#include "logic/static_engine.h"
+#include "rules.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace logic {
+
+using ObjectType = internal::ObjectMap::ObjectType;
+
+namespace {
+    uint64_t randomSeed()
+    {
+        std::random_device device;
+        return (uint64_t{device()} << 32) | device();
+    }
+} // namespace
+
+template<int Width, int Height, int Enemies, int Flowers>
+StaticEngine<Width, Height, Enemies, Flowers>::StaticEngine(const domain::Config& config)
+    : StaticEngine(config, randomSeed())
+{
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+StaticEngine<Width, Height, Enemies, Flowers>::StaticEngine(const domain::Config& config, const uint64_t seed)
+    : config_(config)
+    , rng_(seed)
+    , score_generator_(config_.flower_scores_range.first, config_.flower_scores_range.second)
+{
+    if (!matches(config_)) {
+        throw std::invalid_argument("The config does not match the static engine sizes");
+    }
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::startGame()
+{
+    objects_map_.clean();
+
+    state_.player.scores = 0;
+    state_.player.steps = 0;
+    state_.player.position = objects_map_.placeObject(ObjectType::Player, 0, rng_);
+    state_.sound_effects = domain::SoundEffects::GameStarted;
+
+    for (int i = 0; i < Enemies; ++i) {
+        state_.enemies.position[i] = objects_map_.placeObject(ObjectType::Enemy, i, rng_);
+    }
+    for (int i = 0; i < Flowers; ++i) {
+        state_.flowers.positions[i] = objects_map_.placeObject(ObjectType::Flower, i, rng_);
+    }
+    for (auto& score: state_.flowers.scores) {
+        score = score_generator_.generate(rng_);
+    }
+    assignment_state_.clear();
+
+    state_.game_status = domain::GameStatus::PlayerTurn;
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::startGame(const uint64_t seed)
+{
+    rng_.reseed(seed);
+    startGame();
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+const domain::StepDelta& StaticEngine<Width, Height, Enemies, Flowers>::move(const Vector& direction)
+{
+    step_.player_from = state_.player;
+    step_.status_from = state_.game_status;
+    step_.enemies.clear();
+    step_.flowers.clear();
+    movePlayer(direction);
+    if (state_.game_status == domain::GameStatus::EnemiesTurn) {
+        moveEnemies();
+    }
+    step_.player_to = state_.player;
+    step_.status_to = state_.game_status;
+    step_.sound_effects = state_.sound_effects;
+    return step_;
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::movePlayer(const Vector& direction)
+{
+    state_.sound_effects = domain::SoundEffects::None;
+    Position new_pos = state_.player.position + direction;
+    if (new_pos[0] < 0 || new_pos[0] >= Width || new_pos[1] < 0 || new_pos[1] >= Height) {
+        state_.sound_effects = domain::SoundEffects::PlayerCouldNotMove;
+        return;
+    }
+
+    switch (objects_map_.getType(new_pos)) {
+    case ObjectType::Empty:
+        movePlayerTo(new_pos);
+        break;
+    case ObjectType::Player:
+        throw std::logic_error("seconds player!");
+    case ObjectType::Enemy:
+    case ObjectType::Wall:
+        state_.sound_effects = domain::SoundEffects::PlayerCouldNotMove;
+        return;
+    case ObjectType::Flower: {
+        const auto flower_index = objects_map_.getId(new_pos);
+        movePlayerTo(new_pos);
+        state_.player.scores += state_.flowers.scores[flower_index];
+        state_.sound_effects = domain::SoundEffects::PlayerAteFlower;
+        placeFlower(flower_index);
+        break;
+    }
+    }
+    updateStatusAfterPlayerHasMoved();
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::movePlayerTo(const Position& new_pos)
+{
+    objects_map_.setType(state_.player.position, ObjectType::Empty);
+    state_.player.position = new_pos;
+    objects_map_.setType(state_.player.position, ObjectType::Player);
+    state_.player.steps++;
+    state_.sound_effects = domain::SoundEffects::PlayerMoved;
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::placeFlower(const int index)
+{
+    const auto old_position = state_.flowers.positions[index];
+    const auto old_score = state_.flowers.scores[index];
+    state_.flowers.positions[index] = objects_map_.placeObject(ObjectType::Flower, index, rng_);
+    state_.flowers.scores[index] = score_generator_.generate(rng_);
+    step_.flowers.push_back(
+        {static_cast<uint32_t>(index),
+         old_position,
+         state_.flowers.positions[index],
+         old_score,
+         state_.flowers.scores[index]});
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::updateStatusAfterPlayerHasMoved()
+{
+    if (state_.player.scores >= config_.min_player_scores) {
+        state_.game_status = domain::GameStatus::PlayerWon;
+        state_.sound_effects = domain::SoundEffects::PlayerWon;
+    } else if (state_.player.steps >= config_.max_player_steps) {
+        state_.game_status = domain::GameStatus::PlayerLost;
+        state_.sound_effects = domain::SoundEffects::PlayerLost;
+    } else {
+        state_.game_status = domain::GameStatus::EnemiesTurn;
+    }
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::moveEnemies()
+{
+    // the flowers nearest to the player, ordered by the distance and the index as the other engines do
+    std::array<int, Flowers> keys;
+    for (int i = 0; i < Flowers; ++i) {
+        keys[i] = internal::distanceBetween(state_.flowers.positions[i], state_.player.position) * Flowers + i;
+    }
+    std::partial_sort(keys.begin(), keys.begin() + flowers_to_handle, keys.end());
+    std::array<int, flowers_to_handle> flowers;
+    for (int i = 0; i < flowers_to_handle; ++i) {
+        flowers[i] = keys[i] % Flowers;
+    }
+
+    if (config_.enemies_strategy == domain::EnemiesStrategy::Optimal) {
+        const auto enemies =
+            assignment_.solve(assignment_state_, flowers, Enemies, [&](const int flower, const int enemy) {
+                return internal::distanceBetween(
+                    state_.flowers.positions[flowers[flower]], state_.enemies.position[enemy]);
+            });
+        for (int i = 0; i < flowers_to_handle; ++i) {
+            forwardEnemy(enemies[i], state_.flowers.positions[flowers[i]]);
+        }
+    } else {
+        std::array<bool, Enemies> enemy_assigned{};
+        for (const auto flower: flowers) {
+            const auto& flower_position = state_.flowers.positions[flower];
+            // the lowest index among the nearest enemies
+            int enemy = -1;
+            int enemy_distance = 0;
+            for (int i = 0; i < Enemies; ++i) {
+                const auto distance = internal::distanceBetween(flower_position, state_.enemies.position[i]);
+                if (!enemy_assigned[i] && (enemy < 0 || distance < enemy_distance)) {
+                    enemy = i;
+                    enemy_distance = distance;
+                }
+            }
+            enemy_assigned[enemy] = true;
+            forwardEnemy(enemy, flower_position);
+        }
+    }
+
+    state_.game_status = domain::GameStatus::PlayerTurn;
+}
+
+template<int Width, int Height, int Enemies, int Flowers>
+void StaticEngine<Width, Height, Enemies, Flowers>::forwardEnemy(const int enemy_index, const Position& flower)
+{
+    const domain::Size field_size{Width, Height};
+    auto& enemy = state_.enemies.position[enemy_index];
+    const auto step = internal::findEnemyStep<domain::Scalar>(objects_map_, field_size, enemy, flower);
+    if (!step) {
+        return; // can't move enemy
+    }
+    const auto flower_index = objects_map_.getId(step->position);
+    objects_map_.setType(enemy, ObjectType::Empty);
+    objects_map_.setType(step->position, ObjectType::Enemy, enemy_index);
+    step_.enemies.push_back({static_cast<uint32_t>(enemy_index), enemy, step->position});
+    enemy = step->position;
+    if (step->place == ObjectType::Flower) {
+        placeFlower(flower_index);
+    }
+}
+
+// the configurations in use, add a line to play another one
+template class StaticEngine<18, 18, 5, 15>;
+
+} // namespace logic
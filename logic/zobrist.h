@@ -0,0 +1,37 @@
+#pragma once
+
+#include "logic/object_map.h"
+
+#include <cstdint>
+
+namespace logic::internal::zobrist {
+
+// Keys of the Zobrist hash of a position. A key is the splitmix64 finalizer of its inputs rather than a table entry,
+// so the keys are the same in every run and take no memory on the large fields.
+
+inline uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// The object of the type on the cell x * height + y
+inline uint64_t cellKey(const int64_t cell, const ObjectMap::ObjectType type)
+{
+    return mix(static_cast<uint64_t>(cell) * 8 + static_cast<uint64_t>(type) + 0x9e3779b97f4a7c15ull);
+}
+
+// The flower of the score on the cell
+inline uint64_t flowerKey(const int64_t cell, const unsigned score)
+{
+    return mix(cellKey(cell, ObjectMap::ObjectType::Flower) + score);
+}
+
+// The player steps and scores
+inline uint64_t playerKey(const unsigned steps, const unsigned scores)
+{
+    return mix((uint64_t{steps} << 32 | scores) ^ 0x3c6ef372fe94f82aull);
+}
+
+} // namespace logic::internal::zobrist
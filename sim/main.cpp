@@ -0,0 +1,124 @@
+#include "runner.h"
+
+#include "config/config.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <expected>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+struct Options {
+    std::optional<std::filesystem::path> config_path;
+    uint64_t games{10000};
+    uint64_t seed{1};
+    unsigned threads{std::max(std::thread::hardware_concurrency(), 1u)};
+};
+
+constexpr std::string_view usage =
+    "Usage: shadok_sim [--config <file.toml>] [--games <count>] [--seed <first seed>] [--threads <count>]";
+
+std::expected<uint64_t, std::string> parseNumber(const std::string_view name, const std::string_view text)
+{
+    uint64_t value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size()) {
+        return std::unexpected(std::format("Invalid value '{}' of {}", text, name));
+    }
+    return value;
+}
+
+std::expected<Options, std::string> parseOptions(const int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i += 2) {
+        const std::string_view name = argv[i];
+        if (i + 1 >= argc) {
+            return std::unexpected(std::format("Missing value of {}\n{}", name, usage));
+        }
+        const std::string_view value = argv[i + 1];
+        if (name == "--config") {
+            options.config_path = value;
+        } else if (name == "--games") {
+            auto games = parseNumber(name, value);
+            if (!games) {
+                return std::unexpected(games.error());
+            }
+            options.games = *games;
+        } else if (name == "--seed") {
+            auto seed = parseNumber(name, value);
+            if (!seed) {
+                return std::unexpected(seed.error());
+            }
+            options.seed = *seed;
+        } else if (name == "--threads") {
+            auto threads = parseNumber(name, value);
+            if (!threads || *threads == 0) {
+                return std::unexpected(std::format("Invalid value '{}' of {}", value, name));
+            }
+            options.threads = static_cast<unsigned>(*threads);
+        } else {
+            return std::unexpected(std::format("Unknown option {}\n{}", name, usage));
+        }
+    }
+    return options;
+}
+
+std::expected<domain::Config, std::string> getConfig(const Options& options)
+{
+    if (!options.config_path) {
+        return getDefaultConfig();
+    }
+    auto config = loadConfig(*options.config_path);
+    if (!config) {
+        return config;
+    }
+    if (auto valid = validateConfig(*config); !valid) {
+        return std::unexpected(valid.error());
+    }
+    return config;
+}
+
+void printStatistics(const Statistics& stat, const unsigned threads, const std::chrono::duration<double> elapsed)
+{
+    const auto games = static_cast<double>(std::max<uint64_t>(stat.games, 1));
+    std::cout << std::format("games:         {}\n", stat.games);
+    std::cout << std::format("win rate:      {:.2f}%\n", 100.0 * static_cast<double>(stat.won) / games);
+    std::cout << std::format("stuck:         {}\n", stat.stuck);
+    std::cout << std::format("average score: {:.2f}\n", static_cast<double>(stat.scores) / games);
+    std::cout << std::format("average steps: {:.2f}\n", static_cast<double>(stat.steps) / games);
+    std::cout << std::format("threads:       {}\n", threads);
+    std::cout << std::format("elapsed:       {:.3f} s\n", elapsed.count());
+    std::cout << std::format("games/second:  {:.0f}\n", static_cast<double>(stat.games) / elapsed.count());
+}
+
+} // namespace
+
+int main(const int argc, char** argv)
+{
+    try {
+        const auto options = parseOptions(argc, argv);
+        if (!options) {
+            std::cerr << options.error() << std::endl;
+            return 1;
+        }
+        const auto config = getConfig(*options);
+        if (!config) {
+            std::cerr << config.error() << std::endl;
+            return 1;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const auto statistics = runGames(*config, options->seed, options->games, options->threads);
+        printStatistics(statistics, options->threads, std::chrono::steady_clock::now() - start);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
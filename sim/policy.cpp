@@ -0,0 +1,64 @@
+#include "policy.h"
+
+#include "logic/static_engine.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+    constexpr std::array<std::array<int, 2>, 8> directions{{
+        {1, 0},
+        {1, 1},
+        {0, 1},
+        {-1, 1},
+        {-1, 0},
+        {-1, -1},
+        {0, -1},
+        {1, -1},
+    }};
+
+    template<class Scalar>
+    int distanceBetween(const domain::BasicPosition<Scalar>& p1, const domain::BasicPosition<Scalar>& p2)
+    {
+        return (p1.template cast<int>() - p2.template cast<int>()).array().abs().maxCoeff();
+    }
+
+    template<class Scalar>
+    bool isInside(const domain::Config& config, const domain::BasicPosition<Scalar>& pos)
+    {
+        return pos[0] >= 0 && pos[0] < config.field_size[0] && pos[1] >= 0 && pos[1] < config.field_size[1];
+    }
+} // namespace
+
+template<class State>
+std::optional<decltype(State::player.position)> greedyPlayerMove(const domain::Config& config, const State& state)
+{
+    using Scalar = typename decltype(State::player.position)::Scalar;
+    std::optional<domain::BasicVector<Scalar>> best_move;
+    int best_distance = std::numeric_limits<int>::max();
+    for (const auto& [dx, dy]: directions) {
+        const domain::BasicVector<Scalar> direction{static_cast<Scalar>(dx), static_cast<Scalar>(dy)};
+        const domain::BasicPosition<Scalar> new_pos = state.player.position + direction;
+        if (!isInside(config, new_pos) || std::ranges::find(state.enemies.position, new_pos) !=
+                state.enemies.position.end()) {
+            continue;
+        }
+        int distance = std::numeric_limits<int>::max();
+        for (const auto& flower: state.flowers.positions) {
+            distance = std::min(distance, distanceBetween(flower, new_pos));
+        }
+        if (distance < best_distance) {
+            best_distance = distance;
+            best_move = direction;
+        }
+    }
+    return best_move;
+}
+
+template std::optional<domain::BasicVector<int8_t>> greedyPlayerMove(
+    const domain::Config& config, const domain::BasicState<int8_t>& state);
+template std::optional<domain::BasicVector<int16_t>> greedyPlayerMove(
+    const domain::Config& config, const domain::BasicState<int16_t>& state);
+template std::optional<domain::Vector> greedyPlayerMove(
+    const domain::Config& config, const logic::DefaultStaticEngine::State& state);
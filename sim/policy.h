@@ -0,0 +1,11 @@
+#pragma once
+#include "domain/config.h"
+#include "domain/state.h"
+
+#include <optional>
+
+// Greedy player: steps to the free neighbour cell closest to any flower.
+// Returns nullopt when all the neighbour cells are blocked.
+// State is domain::BasicState or another state with the same members.
+template<class State>
+std::optional<decltype(State::player.position)> greedyPlayerMove(const domain::Config& config, const State& state);
@@ -0,0 +1,148 @@
+#include "runner.h"
+
+#include "logic/engine.h"
+#include "logic/static_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Cells per object from which the sparse map is faster than the packed one
+constexpr int64_t sparse_cells_per_object = 256;
+
+// Range of chunks [begin, end) packed into one atomic word. The owner takes chunks from the front,
+// a thief splits off the back half. Chunks only move forward, so a stale compare-exchange can not succeed.
+class WorkQueue {
+public:
+    void assign(const uint32_t begin, const uint32_t end) { range_.store(pack(begin, end), std::memory_order_release); }
+
+    std::optional<uint32_t> pop()
+    {
+        auto range = range_.load(std::memory_order_acquire);
+        for (;;) {
+            const auto [begin, end] = unpack(range);
+            if (begin >= end) {
+                return std::nullopt;
+            }
+            if (range_.compare_exchange_weak(range, pack(begin + 1, end), std::memory_order_acq_rel)) {
+                return begin;
+            }
+        }
+    }
+
+    bool stealInto(WorkQueue& thief)
+    {
+        auto range = range_.load(std::memory_order_acquire);
+        for (;;) {
+            const auto [begin, end] = unpack(range);
+            if (begin >= end) {
+                return false;
+            }
+            const auto middle = begin + (end - begin) / 2;
+            if (range_.compare_exchange_weak(range, pack(begin, middle), std::memory_order_acq_rel)) {
+                thief.assign(middle, end);
+                return true;
+            }
+        }
+    }
+
+private:
+    alignas(64) std::atomic<uint64_t> range_{0};
+
+    static uint64_t pack(const uint32_t begin, const uint32_t end) { return (uint64_t{begin} << 32) | end; }
+    static std::pair<uint32_t, uint32_t> unpack(const uint64_t range)
+    {
+        return {static_cast<uint32_t>(range >> 32), static_cast<uint32_t>(range)};
+    }
+};
+
+struct alignas(64) WorkerResult {
+    Statistics statistics;
+    std::exception_ptr error;
+};
+
+template<class Engine>
+Statistics runGames(const domain::Config& config, const uint64_t first_seed, const uint64_t count, unsigned threads)
+{
+    threads = std::max(threads, 1u);
+    const uint64_t chunk_size = std::max<uint64_t>(64, count >> 31);
+    const auto chunks = static_cast<uint32_t>((count + chunk_size - 1) / chunk_size);
+
+    std::vector<WorkQueue> queues(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues[i].assign(
+            static_cast<uint32_t>(uint64_t{chunks} * i / threads),
+            static_cast<uint32_t>(uint64_t{chunks} * (i + 1) / threads));
+    }
+    std::vector<WorkerResult> results(threads);
+
+    const auto worker = [&](const unsigned id) {
+        try {
+            Engine engine(config, first_seed);
+            for (;;) {
+                while (const auto chunk = queues[id].pop()) {
+                    const auto begin = *chunk * chunk_size;
+                    const auto end = std::min(begin + chunk_size, count);
+                    for (auto game = begin; game < end; ++game) {
+                        playGame(engine, config, first_seed + game, results[id].statistics);
+                    }
+                }
+                bool stolen = false;
+                for (unsigned k = 1; k < threads && !stolen; ++k) {
+                    stolen = queues[(id + k) % threads].stealInto(queues[id]);
+                }
+                if (!stolen) {
+                    break;
+                }
+            }
+        } catch (...) {
+            results[id].error = std::current_exception();
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned i = 1; i < threads; ++i) {
+            workers.emplace_back(worker, i);
+        }
+        worker(0);
+    }
+
+    Statistics total;
+    for (const auto& result: results) {
+        if (result.error) {
+            std::rethrow_exception(result.error);
+        }
+        total += result.statistics;
+    }
+    return total;
+}
+
+} // namespace
+
+Statistics runGames(
+    const domain::Config& config, const uint64_t first_seed, const uint64_t count, const unsigned threads)
+{
+    if (logic::DefaultStaticEngine::matches(config)) {
+        return runGames<logic::DefaultStaticEngine>(config, first_seed, count, threads);
+    }
+    // the bitboard map and the compact coordinates type are faster, the larger types are for the larger fields
+    if (config.field_size.maxCoeff() <= logic::internal::BitboardObjectMap::max_side) {
+        return runGames<logic::BitboardEngine>(config, first_seed, count, threads);
+    }
+    if (config.field_size.maxCoeff() <= std::numeric_limits<int8_t>::max()) {
+        return runGames<logic::BasicEngine<int8_t>>(config, first_seed, count, threads);
+    }
+    // the dense maps pay for every cell on each game start, a sparse field pays only for its objects
+    const auto area = static_cast<int64_t>(config.field_size.prod());
+    const auto objects = int64_t{1} + config.number_of_enemies + config.number_of_flowers;
+    if (area >= sparse_cells_per_object * objects) {
+        return runGames<logic::SparseEngine>(config, first_seed, count, threads);
+    }
+    return runGames<logic::PackedEngine>(config, first_seed, count, threads);
+}
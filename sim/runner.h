@@ -0,0 +1,7 @@
+#pragma once
+#include "simulation.h"
+
+// Plays games with seeds first_seed, first_seed + 1, ... first_seed + count - 1 on the worker threads.
+// The games are spread with work stealing, every worker owns its engine and statistics,
+// and the result does not depend on the number of threads.
+Statistics runGames(const domain::Config& config, uint64_t first_seed, uint64_t count, unsigned threads);
@@ -0,0 +1,48 @@
+#include "simulation.h"
+
+#include "policy.h"
+
+#include "logic/engine.h"
+#include "logic/static_engine.h"
+
+Statistics& Statistics::operator+=(const Statistics& other)
+{
+    games += other.games;
+    won += other.won;
+    lost += other.lost;
+    stuck += other.stuck;
+    scores += other.scores;
+    steps += other.steps;
+    return *this;
+}
+
+template<class Engine>
+void playGame(Engine& engine, const domain::Config& config, const uint64_t seed, Statistics& statistics)
+{
+    engine.startGame(seed);
+    const auto& state = engine.getState();
+    while (state.game_status == domain::GameStatus::PlayerTurn) {
+        const auto move = greedyPlayerMove(config, state);
+        if (!move) {
+            statistics.stuck++;
+            break;
+        }
+        engine.move(*move);
+    }
+    statistics.games++;
+    statistics.won += state.game_status == domain::GameStatus::PlayerWon;
+    statistics.lost += state.game_status == domain::GameStatus::PlayerLost;
+    statistics.scores += state.player.scores;
+    statistics.steps += state.player.steps;
+}
+
+template void playGame(
+    logic::BasicEngine<int8_t>& engine, const domain::Config& config, uint64_t seed, Statistics& statistics);
+template void playGame(
+    logic::PackedEngine& engine, const domain::Config& config, uint64_t seed, Statistics& statistics);
+template void playGame(
+    logic::SparseEngine& engine, const domain::Config& config, uint64_t seed, Statistics& statistics);
+template void playGame(
+    logic::BitboardEngine& engine, const domain::Config& config, uint64_t seed, Statistics& statistics);
+template void playGame(
+    logic::DefaultStaticEngine& engine, const domain::Config& config, uint64_t seed, Statistics& statistics);
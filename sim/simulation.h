@@ -0,0 +1,20 @@
+#pragma once
+#include "domain/config.h"
+
+#include <cstdint>
+
+struct Statistics {
+    uint64_t games{};
+    uint64_t won{};
+    uint64_t lost{};
+    // games where the player was surrounded and could not move at all
+    uint64_t stuck{};
+    uint64_t scores{};
+    uint64_t steps{};
+
+    Statistics& operator+=(const Statistics& other);
+};
+
+// Plays one game started with the seed and adds its outcome to the statistics
+template<class Engine>
+void playGame(Engine& engine, const domain::Config& config, uint64_t seed, Statistics& statistics);
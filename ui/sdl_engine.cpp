@@ -203,8 +203,8 @@ SDL_Rect SdlEngine::getTransitionCell(
 
 std::vector<SDL_Rect> SdlEngine::getTransitionCells(
         double fraction,
-        const std::vector<domain::Position>& from_positions,
-        const std::vector<domain::Position>& to_positions) const noexcept
+        const std::span<const domain::Position> from_positions,
+        const std::span<const domain::Position> to_positions) const noexcept
 {
     assert(from_positions.size() == to_positions.size());
     std::vector<SDL_Rect> cells(from_positions.size());
@@ -227,14 +227,14 @@ SDL_Rect SdlEngine::getCell(const domain::Position& position) const noexcept
     };
 }
 
-std::vector<SDL_Rect> SdlEngine::getCells(const std::vector<domain::Position>& positions) const noexcept
+std::vector<SDL_Rect> SdlEngine::getCells(const std::span<const domain::Position> positions) const noexcept
 {
     std::vector<SDL_Rect> cells(positions.size());
     std::ranges::transform(positions, cells.begin(), std::bind_front(&SdlEngine::getCell, this));
     return cells;
 }
 
-std::vector<Uint8> SdlEngine::getFlowersColorMod(const std::vector<unsigned>& scores) const
+std::vector<Uint8> SdlEngine::getFlowersColorMod(const std::span<const unsigned> scores) const
 {
     std::vector<Uint8> alpha(scores.size());
     std::ranges::transform(
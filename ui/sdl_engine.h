@@ -5,6 +5,8 @@
 #include "surface.h"
 
 #include <memory>
+#include <span>
+#include <vector>
 
 #include <magic_enum.hpp>
 
@@ -44,17 +46,17 @@ private:
     void drawField() const;
     void drawEnemies(double fraction, const domain::Enemies& from_enemies, const domain::Enemies& to_enemies) const;
     void drawPlayer(const double frac, const domain::Player& from_player, const domain::Player& to_player) const;
-    [[nodiscard]] std::vector<Uint8> getFlowersColorMod(const std::vector<unsigned>& scores) const;
+    [[nodiscard]] std::vector<Uint8> getFlowersColorMod(std::span<const unsigned> scores) const;
     void drawFlowers(double fraction, const domain::Flowers& from_flowers, const domain::Flowers& to_flowers) const;
     static SDL_Color getStatusColor(domain::GameStatus game_status);
     void drawStatus(double frac, const domain::State& from_state, const domain::State& to_state) const;
     void drawMessage(double frac, const domain::GameStatus& from_state, const domain::GameStatus& to_state) const;
     [[nodiscard]] std::vector<SDL_Rect> getTransitionCells(
             double fraction,
-            const std::vector<domain::Position>& from_positions,
-            const std::vector<domain::Position>& to_positions) const noexcept;
+            std::span<const domain::Position> from_positions,
+            std::span<const domain::Position> to_positions) const noexcept;
     SDL_Rect getTransitionCell(double frac, const domain::Position& from_position, const domain::Position& to_position) const noexcept;
-    [[nodiscard]] std::vector<SDL_Rect> getCells(const std::vector<domain::Position>& positions) const noexcept;
+    [[nodiscard]] std::vector<SDL_Rect> getCells(std::span<const domain::Position> positions) const noexcept;
     SDL_Rect getCell(const domain::Position& position) const noexcept;
 
     void reloadResources();